@@ -0,0 +1,177 @@
+// -----------------------------
+// projects/deque/BlockCompare.h
+// -----------------------------
+
+#ifndef BlockCompare_h
+#define BlockCompare_h
+
+// --------
+// includes
+// --------
+
+#include <cstddef>     // size_t
+#include <type_traits> // integral_constant, is_integral, is_same
+
+#if defined(__GNUC__) && defined(__SSE2__) && (defined(__x86_64__) || defined(__i386__))
+#define BLOCK_COMPARE_SIMD 1
+#include <immintrin.h> // _mm*, _mm256*
+#else
+#define BLOCK_COMPARE_SIMD 0
+#endif
+
+// ---------------
+// mismatch_scalar
+// ---------------
+
+/**
+ * @param a - first array
+ * @param b - second array
+ * @param n - length of both
+ * @return index of the first i with !(a[i] == b[i]), or n
+ */
+template <typename T>
+std::size_t mismatch_scalar (const T* a, const T* b, std::size_t n) {
+    for (std::size_t i = 0; i != n; ++i)
+        if (!(a[i] == b[i]))
+            return i;
+    return n;}
+
+#if BLOCK_COMPARE_SIMD
+
+// --------
+// has_avx2
+// --------
+
+/**
+ * @return whether the running cpu has AVX2, asked once
+ */
+inline bool has_avx2 () {
+    static const bool r = __builtin_cpu_supports("avx2");
+    return r;}
+
+// --------------
+// mismatch_bytes
+// --------------
+
+/**
+ * bitwise kernels, right for any integral type: the first differing byte
+ * lies in the first differing element
+ */
+inline std::size_t mismatch_bytes_sse2 (const unsigned char* a, const unsigned char* b, std::size_t n) {
+    std::size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        const __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+        const unsigned m = ~_mm_movemask_epi8(_mm_cmpeq_epi8(x, y)) & 0xFFFFu;
+        if (m)
+            return i + __builtin_ctz(m);}
+    return i + mismatch_scalar(a + i, b + i, n - i);}
+
+__attribute__((target("avx2")))
+inline std::size_t mismatch_bytes_avx2 (const unsigned char* a, const unsigned char* b, std::size_t n) {
+    std::size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        const __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        const unsigned m = ~static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, y)));
+        if (m)
+            return i + __builtin_ctz(m);}
+    return i + mismatch_bytes_sse2(a + i, b + i, n - i);}
+
+// ---------------
+// mismatch_double
+// ---------------
+
+/**
+ * floating point kernels compare by value, so 0.0 equals -0.0 and a NaN
+ * equals nothing, the same as ==
+ */
+inline std::size_t mismatch_double_sse2 (const double* a, const double* b, std::size_t n) {
+    std::size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        const unsigned m = ~_mm_movemask_pd(_mm_cmpeq_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i))) & 0x3u;
+        if (m)
+            return i + __builtin_ctz(m);}
+    return i + mismatch_scalar(a + i, b + i, n - i);}
+
+__attribute__((target("avx2")))
+inline std::size_t mismatch_double_avx2 (const double* a, const double* b, std::size_t n) {
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const __m256d e = _mm256_cmp_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i), _CMP_EQ_OQ);
+        const unsigned m = ~_mm256_movemask_pd(e) & 0xFu;
+        if (m)
+            return i + __builtin_ctz(m);}
+    return i + mismatch_scalar(a + i, b + i, n - i);}
+
+// --------------
+// mismatch_float
+// --------------
+
+inline std::size_t mismatch_float_sse2 (const float* a, const float* b, std::size_t n) {
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const unsigned m = ~_mm_movemask_ps(_mm_cmpeq_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i))) & 0xFu;
+        if (m)
+            return i + __builtin_ctz(m);}
+    return i + mismatch_scalar(a + i, b + i, n - i);}
+
+__attribute__((target("avx2")))
+inline std::size_t mismatch_float_avx2 (const float* a, const float* b, std::size_t n) {
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m256 e = _mm256_cmp_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), _CMP_EQ_OQ);
+        const unsigned m = ~_mm256_movemask_ps(e) & 0xFFu;
+        if (m)
+            return i + __builtin_ctz(m);}
+    return i + mismatch_scalar(a + i, b + i, n - i);}
+
+// -------------
+// mismatch_simd
+// -------------
+
+template <typename T>
+std::size_t mismatch_simd (const T* a, const T* b, std::size_t n, std::true_type, std::false_type) {
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(a);
+    const unsigned char* q = reinterpret_cast<const unsigned char*>(b);
+    const std::size_t    s = n * sizeof(T);
+    return (has_avx2() ? mismatch_bytes_avx2(p, q, s) : mismatch_bytes_sse2(p, q, s)) / sizeof(T);}
+
+inline std::size_t mismatch_simd (const double* a, const double* b, std::size_t n, std::false_type, std::true_type) {
+    return has_avx2() ? mismatch_double_avx2(a, b, n) : mismatch_double_sse2(a, b, n);}
+
+inline std::size_t mismatch_simd (const float* a, const float* b, std::size_t n, std::false_type, std::true_type) {
+    return has_avx2() ? mismatch_float_avx2(a, b, n) : mismatch_float_sse2(a, b, n);}
+
+template <typename T>
+std::size_t mismatch_simd (const T* a, const T* b, std::size_t n, std::false_type, std::false_type) {
+    return mismatch_scalar(a, b, n);}
+
+#endif // BLOCK_COMPARE_SIMD
+
+// --------------
+// block_mismatch
+// --------------
+
+/**
+ * @param a - first array
+ * @param b - second array
+ * @param n - length of both
+ * @return index of the first i with !(a[i] == b[i]), or n
+ * integral types compare 16 or 32 bytes at a time, float and double a whole
+ * vector register of lanes at a time, AVX2 when the cpu has it, else SSE2
+ * everything else, and every other target, takes the scalar loop
+ */
+#if BLOCK_COMPARE_SIMD
+template <typename T>
+std::size_t block_mismatch (const T* a, const T* b, std::size_t n) {
+    return mismatch_simd(a, b, n,
+        std::integral_constant<bool, std::is_integral<T>::value>(),
+        std::integral_constant<bool, std::is_same<T, double>::value || std::is_same<T, float>::value>());}
+#else
+template <typename T>
+std::size_t block_mismatch (const T* a, const T* b, std::size_t n) {
+    return mismatch_scalar(a, b, n);}
+#endif
+
+#endif // BlockCompare_h
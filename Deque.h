@@ -16,14 +16,38 @@
 // includes
 // --------
 
-#include <algorithm> // copy, equal, lexicographical_compare, max, swap
-#include <cassert>   // assert
-#include <iterator>  // iterator, bidirectional_iterator_tag
-#include <memory>    // allocator
-#include <stdexcept> // out_of_range
-#include <utility>   // !=, <=, >, >=
+#include <algorithm>        // copy, count, equal, fill, find, for_each, lexicographical_compare, max, move, rotate, swap
+#include <cassert>          // assert
+#include <cerrno>           // errno, EINTR
+#include <cstddef>          // size_t
+#include <cstdint>          // uint32_t, uint64_t
+#include <cstdio>           // fprintf
+#include <cstdlib>          // abort
+#include <cstring>          // memcpy
+#include <initializer_list> // initializer_list
+#include <istream>          // istream
+#include <iterator>         // forward_iterator_tag, iterator, iterator_traits, random_access_iterator_tag
+#include <memory>           // allocator, allocator_traits
+#include <mutex>            // lock_guard, mutex
+#include <numeric>          // accumulate
+#include <ostream>          // ostream
+#include <stdexcept>        // out_of_range, runtime_error
+#include <system_error>     // system_category, system_error
+#include <type_traits>      // enable_if, false_type, integral_constant, is_arithmetic, is_empty, is_integral, is_trivially_copyable, true_type
+#include <utility>          // !=, <=, >, >=, declval, forward, move, move_if_noexcept
 #include <cmath>
 
+#include "BlockCompare.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define DEQUE_GATHER_IO 1
+#include <climits>          // IOV_MAX
+#include <sys/uio.h>        // iovec, readv, writev
+#include <unistd.h>         // read
+#else
+#define DEQUE_GATHER_IO 0
+#endif
+
 
 using namespace std;
 
@@ -36,27 +60,134 @@ using std::rel_ops::operator<=;
 using std::rel_ops::operator>;
 using std::rel_ops::operator>=;
 
+// -----------------
+// trivial_construct
+// -----------------
+
+/**
+ * whether A constructs a T from a const T& the way std::allocator does,
+ * either by not declaring construct at all or by inheriting it
+ * only then may a trivially copyable T be copied with memcpy
+ */
+template <typename A, typename T, typename = void>
+struct declares_construct : std::false_type {};
+
+template <typename A, typename T>
+struct declares_construct<A, T, decltype(void(std::declval<A&>().construct(std::declval<T*>(), std::declval<const T&>())))> : std::true_type {};
+
+template <typename A, typename T, typename = void>
+struct inherits_construct : std::false_type {};
+
+template <typename A, typename T>
+struct inherits_construct<A, T, typename std::enable_if<std::is_same<
+        decltype(&A::template construct<T, const T&>),
+        decltype(&std::allocator<T>::template construct<T, const T&>)>::value>::type> : std::true_type {};
+
+template <typename A, typename T>
+struct trivial_construct : std::integral_constant<bool,
+        std::is_trivially_copyable<T>::value &&
+        (!declares_construct<A, T>::value || inherits_construct<A, T>::value)> {};
+
+// ---------------
+// trivial_destroy
+// ---------------
+
+/**
+ * whether A destroys a T the way std::allocator does and T has nothing to do
+ * only then may destroy skip the elements
+ */
+template <typename A, typename T, typename = void>
+struct declares_destroy : std::false_type {};
+
+template <typename A, typename T>
+struct declares_destroy<A, T, decltype(void(std::declval<A&>().destroy(std::declval<T*>())))> : std::true_type {};
+
+template <typename A, typename T, typename = void>
+struct inherits_destroy : std::false_type {};
+
+template <typename A, typename T>
+struct inherits_destroy<A, T, typename std::enable_if<std::is_same<
+        decltype(&A::template destroy<T>),
+        decltype(&std::allocator<T>::template destroy<T>)>::value>::type> : std::true_type {};
+
+template <typename A, typename T>
+struct trivial_destroy : std::integral_constant<bool,
+        std::is_trivially_destructible<T>::value &&
+        (!declares_destroy<A, T>::value || inherits_destroy<A, T>::value)> {};
+
+// -------------
+// trivial_range
+// -------------
+
+/**
+ * whether [b, e) of type II can be memcpy'd into storage of type BI:
+ * both are plain pointers to the same trivially copyable type
+ */
+template <typename A, typename II, typename BI>
+struct trivial_range : std::false_type {};
+
+template <typename A, typename T, typename U>
+struct trivial_range<A, U*, T*> : std::integral_constant<bool,
+        std::is_same<typename std::remove_const<U>::type, T>::value &&
+        trivial_construct<A, T>::value> {};
+
 // -------
 // destroy
 // -------
 
 template <typename A, typename BI>
-BI destroy (A& a, BI b, BI e) {
+BI destroy (A& a, BI b, BI e, std::false_type) {
     while (b != e) {
         --e;
-        a.destroy(&*e);}
+        std::allocator_traits<A>::destroy(a, &*e);}
     return b;}
 
+template <typename A, typename BI>
+BI destroy (A&, BI b, BI, std::true_type) {
+    return b;}
+
+template <typename A, typename BI>
+BI destroy (A& a, BI b, BI e) {
+    typedef typename std::iterator_traits<BI>::value_type T;
+    return destroy(a, b, e, trivial_destroy<A, T>());}
+
 // ------------------
 // uninitialized_copy
 // ------------------
 
+template <typename A, typename II, typename BI>
+BI uninitialized_copy (A& a, II b, II e, BI x, std::false_type) {
+    BI p = x;
+    try {
+        while (b != e) {
+            std::allocator_traits<A>::construct(a, &*x, *b);
+            ++b;
+            ++x;}}
+    catch (...) {
+        destroy(a, p, x);
+        throw;}
+    return x;}
+
+template <typename A, typename II, typename BI>
+BI uninitialized_copy (A&, II b, II e, BI x, std::true_type) {
+    if (b != e)
+        std::memcpy(static_cast<void*>(x), static_cast<const void*>(b), (e - b) * sizeof(*x));
+    return x + (e - b);}
+
 template <typename A, typename II, typename BI>
 BI uninitialized_copy (A& a, II b, II e, BI x) {
+    return uninitialized_copy(a, b, e, x, trivial_range<A, II, BI>());}
+
+// ------------------
+// uninitialized_move
+// ------------------
+
+template <typename A, typename II, typename BI>
+BI uninitialized_move (A& a, II b, II e, BI x, std::false_type) {
     BI p = x;
     try {
         while (b != e) {
-            a.construct(&*x, *b);
+            std::allocator_traits<A>::construct(a, &*x, std::move_if_noexcept(*b));
             ++b;
             ++x;}}
     catch (...) {
@@ -64,27 +195,402 @@ BI uninitialized_copy (A& a, II b, II e, BI x) {
         throw;}
     return x;}
 
+template <typename A, typename II, typename BI>
+BI uninitialized_move (A& a, II b, II e, BI x, std::true_type) {
+    return uninitialized_copy(a, b, e, x, std::true_type());}
+
+template <typename A, typename II, typename BI>
+BI uninitialized_move (A& a, II b, II e, BI x) {
+    return uninitialized_move(a, b, e, x, trivial_range<A, II, BI>());}
+
 // ------------------
 // uninitialized_fill
 // ------------------
 
 template <typename A, typename BI, typename U>
-BI uninitialized_fill (A& a, BI b, BI e, const U& v) {
+BI uninitialized_fill (A& a, BI b, BI e, const U& v, std::false_type) {
     BI p = b;
     try {
         while (b != e) {
-            a.construct(&*b, v);
+            std::allocator_traits<A>::construct(a, &*b, v);
             ++b;}}
     catch (...) {
         destroy(a, p, b);
         throw;}
     return e;}
 
+template <typename A, typename BI, typename U>
+BI uninitialized_fill (A&, BI b, BI e, const U& v, std::true_type) {
+    std::fill(b, e, v);
+    return e;}
+
+template <typename A, typename BI, typename U>
+BI uninitialized_fill (A& a, BI b, BI e, const U& v) {
+    typedef typename std::iterator_traits<BI>::value_type T;
+    return uninitialized_fill(a, b, e, v, std::integral_constant<bool,
+        std::is_pointer<BI>::value && std::is_same<T, U>::value && trivial_construct<A, T>::value &&
+        std::is_trivially_copy_assignable<T>::value>());}
+
+// -----------
+// block_bytes
+// -----------
+
+/**
+ * block size policy: each block holds about Bytes bytes, the element count is
+ * Bytes / sizeof(T) rounded down to a power of two and is at least 1
+ */
+template <std::size_t Bytes = 512>
+struct block_bytes {
+    static constexpr std::size_t floor_power_of_two (std::size_t n, std::size_t p = 1) {
+        return (p * 2 <= n) ? floor_power_of_two(n, p * 2) : p;}
+
+    template <typename T>
+    struct elements {
+        static const std::size_t value = floor_power_of_two(Bytes / sizeof(T));};};
+
+// --------------
+// block_elements
+// --------------
+
+/**
+ * block size policy: each block holds exactly N elements
+ */
+template <std::size_t N>
+struct block_elements {
+    template <typename T>
+    struct elements {
+        static const std::size_t value = N;};};
+
+// ----------------
+// geometric_growth
+// ----------------
+
+/**
+ * map growth policy: the block map grows by a factor of Num / Den and is
+ * recentred in place while it would stay no more than Den / Num full
+ */
+template <std::size_t Num = 2, std::size_t Den = 1>
+struct geometric_growth {
+    static_assert(Num > Den, "growth factor must be greater than 1");
+
+    static std::size_t next_size (std::size_t slots, std::size_t needed) {
+        return std::max(slots * Num / Den, needed) + 2;}
+
+    static bool recentre (std::size_t slots, std::size_t needed) {
+        return slots * Den > needed * Num;}};
+
+// ------------
+// fixed_growth
+// ------------
+
+/**
+ * map growth policy: the block map grows by Slots slots at a time and is
+ * recentred in place while a whole increment is still free
+ */
+template <std::size_t Slots = 64>
+struct fixed_growth {
+    static_assert(Slots > 0, "growth increment must be positive");
+
+    static std::size_t next_size (std::size_t slots, std::size_t needed) {
+        return std::max(slots, needed) + Slots;}
+
+    static bool recentre (std::size_t slots, std::size_t needed) {
+        return slots >= needed + Slots;}};
+
+// -----------
+// page_growth
+// -----------
+
+/**
+ * map growth policy: the block map doubles, rounded up to whole pages of
+ * Bytes bytes, and is recentred in place while it is less than half full
+ */
+template <std::size_t Bytes = 4096>
+struct page_growth {
+    static const std::size_t page_slots = (Bytes / sizeof(void*)) ? (Bytes / sizeof(void*)) : 1;
+
+    static std::size_t next_size (std::size_t slots, std::size_t needed) {
+        const std::size_t s = std::max(2 * slots, needed + 2);
+        return (s + page_slots - 1) / page_slots * page_slots;}
+
+    static bool recentre (std::size_t slots, std::size_t needed) {
+        return slots > 2 * needed;}};
+
+// -------
+// segment
+// -------
+
+/**
+ * contiguous run of elements inside one block, as handed out by
+ * my_deque::segments()
+ */
+template <typename P>
+struct segment {
+    P           first;
+    std::size_t count;
+
+    segment (P f, std::size_t n) : first(f), count(n) {}
+
+    P begin () const {
+        return first;}
+
+    P end () const {
+        return first + count;}
+
+    std::size_t size () const {
+        return count;}};
+
+// -------------------
+// deque_stream_header
+// -------------------
+
+/**
+ * what my_deque::write_to puts in front of the elements and read_from
+ * expects, in the byte order of the machine that wrote it
+ */
+struct deque_stream_header {
+    enum {MAGIC = 0x71656431};
+
+    std::uint32_t magic;
+    std::uint32_t element_size;
+    std::uint64_t count;};
+
+// -----------
+// deque_stats
+// -----------
+
+/**
+ * DEQUE_STATS 1 makes every my_deque count what it does, 2 also folds each
+ * deque's counts into global_deque_stats() when it is destroyed or reset;
+ * 0, the default, counts nothing and costs nothing
+ */
+#ifndef DEQUE_STATS
+#define DEQUE_STATS 0
+#endif
+
+/**
+ * snapshot of a deque's counters, as returned by my_deque::stats()
+ */
+struct deque_stats {
+    std::size_t allocations;      // allocator calls for blocks and block maps
+    std::size_t deallocations;
+    std::size_t bytes_reserved;   // bytes of blocks and map held at the snapshot
+    std::size_t growths;          // block maps replaced by a bigger one
+    std::size_t constructions;    // elements built from constructor arguments
+    std::size_t copies;           // elements copy constructed
+    std::size_t moves;            // elements move constructed or shifted by insert and erase
+    std::size_t max_size;
+    std::size_t front_ops;        // pushes and pops at the front
+    std::size_t back_ops;         // pushes and pops at the back
+
+    deque_stats () :
+            allocations(0), deallocations(0), bytes_reserved(0), growths(0), constructions(0),
+            copies(0), moves(0), max_size(0), front_ops(0), back_ops(0) {}
+
+    /**
+     * @param that - counts to add, max_size takes the larger
+     */
+    deque_stats& operator += (const deque_stats& that) {
+        allocations    += that.allocations;
+        deallocations  += that.deallocations;
+        bytes_reserved += that.bytes_reserved;
+        growths        += that.growths;
+        constructions  += that.constructions;
+        copies         += that.copies;
+        moves          += that.moves;
+        max_size        = std::max(max_size, that.max_size);
+        front_ops      += that.front_ops;
+        back_ops       += that.back_ops;
+        return *this;}};
+
+/**
+ * @param fold - counts to add to the totals, or null to read them
+ * @param reset - whether to zero the totals afterwards
+ * @return the totals before any reset
+ */
+inline deque_stats global_deque_stats (const deque_stats* fold, bool reset) {
+    static std::mutex  m;
+    static deque_stats totals;
+    std::lock_guard<std::mutex> g(m);
+    if (fold)
+        totals += *fold;
+    const deque_stats x = totals;
+    if (reset)
+        totals = deque_stats();
+    return x;}
+
+/**
+ * @return the counts every destroyed or reset deque has folded in, with
+ * DEQUE_STATS 2; bytes_reserved is always 0
+ */
+inline deque_stats global_deque_stats () {
+    return global_deque_stats(0, false);}
+
+inline void reset_global_deque_stats () {
+    global_deque_stats(0, true);}
+
+// -----------
+// DEQUE_DEBUG
+// -----------
+
+/**
+ * DEQUE_DEBUG 1 makes my_deque check every index given to operator[] and
+ * stamp every iterator with the deque's generation, which each operation
+ * that moves the block map bumps; an iterator whose generation is old, or
+ * whose block has left the map, is stale, and a bad index or a stale
+ * iterator aborts with a message
+ * 0, the default, checks nothing, at() is then the only checked access
+ */
+#ifndef DEQUE_DEBUG
+#define DEQUE_DEBUG 0
+#endif
+
+/**
+ * @param what - the misuse found
+ */
+inline void deque_debug_failure (const char* what) {
+    std::fprintf(stderr, "%s\n", what);
+    std::abort();}
+
+// ------------
+// deque_memory
+// ------------
+
+/**
+ * where a deque's memory goes, as returned by my_deque::memory_usage()
+ */
+struct deque_memory {
+    std::size_t element_bytes;        // size() elements
+    std::size_t map_bytes;            // the block map
+    std::size_t front_unused_bytes;   // block storage in front of the first element
+    std::size_t back_unused_bytes;    // block storage behind the last element
+    std::size_t spare_bytes;          // blocks on the free list, in no slot of the map
+    std::size_t blocks;               // blocks held, spares included
+    std::size_t partial_blocks;       // blocks holding elements with room left
+
+    deque_memory () :
+            element_bytes(0), map_bytes(0), front_unused_bytes(0), back_unused_bytes(0),
+            spare_bytes(0), blocks(0), partial_blocks(0) {}
+
+    /**
+     * @return every byte the deque holds from its allocators
+     */
+    std::size_t total_bytes () const {
+        return element_bytes + map_bytes + front_unused_bytes + back_unused_bytes + spare_bytes;}};
+
+// --------------------
+// segmented_algorithms
+// --------------------
+
+/**
+ * base of the deque iterators, so that argument dependent lookup finds these
+ * ahead of the std algorithms for unqualified calls on a pair of iterators
+ * each one runs the plain algorithm on one block at a time, where the
+ * elements are contiguous and the inner loop can be vectorized
+ * D is the deque, I the iterator deriving from this
+ */
+template <typename D, typename I>
+struct segmented_algorithms {
+    /**
+     * @param b - iterator to the first element
+     * @param e - iterator one past the last element
+     * @param f - function to apply
+     * @return f after it has seen every element
+     */
+    template <typename F>
+    friend F for_each (I b, I e, F f) {
+        typename D::template segment_view<I> v = D::segments(b, e);
+        for (typename D::template segment_view<I>::iterator s = v.begin(); s != v.end(); ++s)
+            f = std::for_each(s->begin(), s->end(), f);
+        return f;}
+
+    /**
+     * @param b - iterator to the first element
+     * @param e - iterator one past the last element
+     * @param x - output iterator
+     * @return x advanced past the copies
+     */
+    template <typename OI>
+    friend OI copy (I b, I e, OI x) {
+        typename D::template segment_view<I> v = D::segments(b, e);
+        for (typename D::template segment_view<I>::iterator s = v.begin(); s != v.end(); ++s)
+            x = D::copy_segment(s->begin(), s->end(), x);
+        return x;}
+
+    /**
+     * @param b - iterator to the first element
+     * @param e - iterator one past the last element
+     * @param v - value to assign to every element
+     */
+    template <typename V>
+    friend void fill (I b, I e, const V& v) {
+        typename D::template segment_view<I> w = D::segments(b, e);
+        for (typename D::template segment_view<I>::iterator s = w.begin(); s != w.end(); ++s)
+            std::fill(s->begin(), s->end(), v);}
+
+    /**
+     * @param b - iterator to the first element
+     * @param e - iterator one past the last element
+     * @param v - value to look for
+     * @return iterator to the first element equal to v, or e
+     */
+    template <typename V>
+    friend I find (I b, I e, const V& v) {
+        typename D::template segment_view<I> w = D::segments(b, e);
+        typename D::difference_type i = 0;
+        for (typename D::template segment_view<I>::iterator s = w.begin(); s != w.end(); ++s) {
+            typename I::pointer p = std::find(s->begin(), s->end(), v);
+            if (p != s->end())
+                return b + (i + (p - s->begin()));
+            i += s->size();}
+        return e;}
+
+    /**
+     * @param b - iterator to the first element
+     * @param e - iterator one past the last element
+     * @param v - value to count
+     * @return number of elements equal to v
+     */
+    template <typename V>
+    friend typename D::difference_type count (I b, I e, const V& v) {
+        typename D::template segment_view<I> w = D::segments(b, e);
+        typename D::difference_type n = 0;
+        for (typename D::template segment_view<I>::iterator s = w.begin(); s != w.end(); ++s)
+            n += std::count(s->begin(), s->end(), v);
+        return n;}
+
+    /**
+     * @param b - iterator to the first element
+     * @param e - iterator one past the last element
+     * @param v - initial value
+     * @return v plus every element, in order
+     */
+    template <typename V>
+    friend V accumulate (I b, I e, V v) {
+        typename D::template segment_view<I> w = D::segments(b, e);
+        for (typename D::template segment_view<I>::iterator s = w.begin(); s != w.end(); ++s)
+            v = std::accumulate(s->begin(), s->end(), v);
+        return v;}
+
+    /**
+     * @param b - iterator to the first element
+     * @param e - iterator one past the last element
+     * @param v - initial value
+     * @param f - binary operation
+     * @return f folded over v and every element, in order
+     */
+    template <typename V, typename BF>
+    friend V accumulate (I b, I e, V v, BF f) {
+        typename D::template segment_view<I> w = D::segments(b, e);
+        for (typename D::template segment_view<I>::iterator s = w.begin(); s != w.end(); ++s)
+            v = std::accumulate(s->begin(), s->end(), v, f);
+        return v;}};
+
 // -------
 // my_deque
 // -------
 
-template < typename T, typename A = std::allocator<T> >
+template < typename T, typename A = std::allocator<T>, typename B = block_bytes<>, typename G = geometric_growth<> >
 class my_deque {
     public:
         // --------
@@ -92,19 +598,27 @@ class my_deque {
         // --------
 
         typedef A                                        allocator_type;
-        typedef typename allocator_type::value_type      value_type;
+        typedef std::allocator_traits<allocator_type>    alloc_traits;
+        typedef typename alloc_traits::value_type        value_type;
+
+        typedef typename alloc_traits::size_type         size_type;
+        typedef typename alloc_traits::difference_type   difference_type;
 
-        typedef typename allocator_type::size_type       size_type;
-        typedef typename allocator_type::difference_type difference_type;
+        typedef typename alloc_traits::pointer           pointer;
+        typedef typename alloc_traits::const_pointer     const_pointer;
 
-        typedef typename allocator_type::pointer         pointer;
-        typedef typename allocator_type::const_pointer   const_pointer;
+        typedef value_type&                              reference;
+        typedef const value_type&                        const_reference;
 
-        typedef typename allocator_type::reference       reference;
-        typedef typename allocator_type::const_reference const_reference;
+        typedef typename alloc_traits::template rebind_alloc<pointer> p_a_t;
+        typedef std::allocator_traits<p_a_t>             p_a_traits;
+        typedef typename p_a_traits::pointer             p_p;
 
-        typedef typename allocator_type::template rebind<T*>::other p_a_t;
-        typedef typename p_a_t::pointer p_p;
+        typedef B                                        block_policy;
+        typedef G                                        growth_policy;
+
+        class iterator;
+        class const_iterator;
 
     public:
         // -----------
@@ -117,13 +631,12 @@ class my_deque {
          * @return bool
          * returns a boolean indicating whether the two deques are the same size
          *      and hold the same values
+         * compares block against block with block_mismatch
          */
         friend bool operator == (const my_deque& lhs, const my_deque& rhs) {
-            //our code
-            // you must use std::equal()
             if(lhs.size() != rhs.size())
                 return false;
-            return std::equal(lhs._b, lhs._e, rhs._b);
+            return first_mismatch(lhs, rhs, 0, lhs.size()) == lhs.size();
         }
 
         // ----------
@@ -136,13 +649,27 @@ class my_deque {
          * @return bool
          * returns a boolean indicating whether lhs is lexicographically less than
          *                  rhs
+         * arithmetic types skip the equal prefix block against block with
+         * block_mismatch, everything else needs only < and goes through
+         * std::lexicographical_compare()
          */
         friend bool operator < (const my_deque& lhs, const my_deque& rhs) {
-            // our code
-            // you must use std::lexicographical_compare()
-            return std::lexicographical_compare(lhs._b, lhs._e, rhs._b, rhs._e);
+            return less(lhs, rhs, std::is_arithmetic<value_type>());
         }
 
+        // ----
+        // swap
+        // ----
+
+        /**
+         * @param lhs - deque
+         * @param rhs - deque
+         * found by argument dependent lookup, so algorithms that swap through
+         * "using std::swap; swap(x, y)" get the constant time member swap
+         */
+        friend void swap (my_deque& lhs, my_deque& rhs) noexcept {
+            lhs.swap(rhs);}
+
 
 
 
@@ -154,17 +681,42 @@ class my_deque {
         allocator_type _a;
         p_a_t _pa;
 
-        p_p _bucket_begin;
-        p_p _bucket_end;
+        p_p _bucket_begin;          // block map, a null slot has no block
+        p_p _bucket_end;            // the blocks holding the elements and the end are always allocated
+
+        size_type _offset;          // index of the first element, counted from block 0
+        size_type _size;
+
+        pointer   _spare;           // free list of emptied blocks, linked through their storage
+        size_type _spare_count;
+        size_type _spare_limit;
+
+#if DEQUE_STATS
+        deque_stats _stats;         // this deque's own counts, never copied or swapped
+#endif
+
+#if DEQUE_DEBUG
+        size_type _generation = 0;  // bumped by invalidate_iterators, stamped into iterators
+#endif
 
-        pointer _inner_begin; 
-        pointer _data_begin; 
-        pointer _data_end;   
-        pointer _inner_end;  
-   
+        // elements per block, a power of two so that index arithmetic folds
+        // into shifts and masks
+        static const size_type DEFAULT_ARRAY_SIZE = B::template elements<T>::value;
+        static const size_type DEFAULT_BUCKET_SIZE = 8;
+        static const size_type DEFAULT_SPARE_BLOCKS = 4;
 
-        const size_type DEFAULT_ARRAY_SIZE = 10;
-        const size_type DEFAULT_BUCKET_SIZE = 3;
+        // a block can hold the free list link
+        static const bool CAN_RECYCLE = DEFAULT_ARRAY_SIZE * sizeof(T) >= sizeof(pointer);
+
+        // blocks from a stateless allocator can be shared through a per-thread cache,
+        // which frees them with a default constructed allocator
+        static const bool CAN_CACHE = CAN_RECYCLE && std::is_empty<allocator_type>::value &&
+                                      std::is_default_constructible<allocator_type>::value;
+
+        typedef std::integral_constant<bool, CAN_CACHE> can_cache;
+
+        static_assert(DEFAULT_ARRAY_SIZE && !(DEFAULT_ARRAY_SIZE & (DEFAULT_ARRAY_SIZE - 1)),
+                      "block size must be a power of two");
 
     private:
         // -----
@@ -173,23 +725,901 @@ class my_deque {
 
         bool valid () const {
             // our code - taken from Prof. Downings Vector.h example
-            return(!_data_begin && !_data_end) || ((_data_begin <= _data_end));
+            return (!_bucket_begin && !_size) ||
+                   ((_offset + _size < map_size() * DEFAULT_ARRAY_SIZE) && _bucket_begin[(_offset + _size) / DEFAULT_ARRAY_SIZE]);
         }
 
+        // --------
+        // map_size
+        // --------
+
+        /**
+         * @return number of slots in the block map
+         */
+        size_type map_size () const {
+            return _bucket_end - _bucket_begin;}
+
+        // -------
+        // element
+        // -------
+
+        /**
+         * @param i - index relative to the front of the deque, at most size()
+         * @return pointer to the storage for element i
+         */
+        pointer element (size_type i) const {
+            const size_type j = _offset + i;
+            return _bucket_begin[j / DEFAULT_ARRAY_SIZE] + j % DEFAULT_ARRAY_SIZE;}
+
+        // --------------
+        // first_mismatch
+        // --------------
+
+        /**
+         * @param lhs - deque
+         * @param rhs - deque
+         * @param i - index to start at
+         * @param n - index to stop at, at most the smaller size
+         * @return first index in [i, n) where lhs and rhs differ, or n
+         * the pieces end at the block boundaries of either deque, so the
+         * blocks of the two need not line up
+         */
+        static size_type first_mismatch (const my_deque& lhs, const my_deque& rhs, size_type i, size_type n) {
+            while (i != n) {
+                const size_type k = std::min(n - i, std::min(
+                    DEFAULT_ARRAY_SIZE - (lhs._offset + i) % DEFAULT_ARRAY_SIZE,
+                    DEFAULT_ARRAY_SIZE - (rhs._offset + i) % DEFAULT_ARRAY_SIZE));
+                const size_type j = block_mismatch<value_type>(lhs.element(i), rhs.element(i), k);
+                if (j != k)
+                    return i + j;
+                i += k;}
+            return n;}
+
+        // ----
+        // less
+        // ----
+
+        /**
+         * @param lhs - deque
+         * @param rhs - deque
+         * @return whether lhs is lexicographically less than rhs
+         * neither element of a pair that differs but is unordered, as with a
+         * NaN, decides the answer, so the search resumes after it
+         */
+        static bool less (const my_deque& lhs, const my_deque& rhs, std::true_type) {
+            const size_type n = std::min(lhs.size(), rhs.size());
+            size_type i = 0;
+            while ((i = first_mismatch(lhs, rhs, i, n)) != n) {
+                const value_type& x = *lhs.element(i);
+                const value_type& y = *rhs.element(i);
+                if (x < y)
+                    return true;
+                if (y < x)
+                    return false;
+                ++i;}
+            return lhs.size() < rhs.size();}
+
+        static bool less (const my_deque& lhs, const my_deque& rhs, std::false_type) {
+            return std::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());}
+
+        // -----
+        // tally
+        // -----
+
+        /**
+         * @param field - counter to add to, with DEQUE_STATS on
+         * @param n - amount
+         * tally_size records the size as a high water mark
+         */
+#if DEQUE_STATS
+        void tally (std::size_t deque_stats::* field, size_type n = 1) {
+            _stats.*field += n;}
+
+        void tally_size () {
+            _stats.max_size = std::max(_stats.max_size, _size);}
+#else
+        void tally (std::size_t deque_stats::*, size_type = 1) {}
+
+        void tally_size () {}
+#endif
+
+        /**
+         * makes every iterator into this deque stale, with DEQUE_DEBUG on
+         */
+#if DEQUE_DEBUG
+        void invalidate_iterators () {
+            ++_generation;}
+#else
+        void invalidate_iterators () {}
+#endif
+
+        /**
+         * adds this deque's counts to global_deque_stats(), with DEQUE_STATS 2
+         */
+#if DEQUE_STATS == 2
+        void fold_stats () const {
+            global_deque_stats(&_stats, false);}
+#else
+        void fold_stats () const {}
+#endif
+
+        // -----------
+        // block_cache
+        // -----------
+
+        /**
+         * free list of blocks shared by every deque of this type on one thread
+         * the blocks go back to the allocator when the thread exits
+         */
+        struct block_cache {
+            pointer   head;
+            size_type count;
+            size_type limit;
+
+            block_cache () : head(0), count(0), limit(0) {}
+
+            ~block_cache () {
+                allocator_type a;
+                while (head) {
+                    pointer p = head;
+                    head = next_spare(p);
+                    alloc_traits::deallocate(a, p, DEFAULT_ARRAY_SIZE);}}};
+
+        static block_cache& thread_cache () {
+            static thread_local block_cache c;
+            return c;}
+
+        /**
+         * @return a block from the thread cache, or null
+         * the false_type overloads keep thread_cache, and the allocator it
+         * default constructs, out of deques that cannot cache
+         */
+        static pointer take_cached (std::true_type) {
+            block_cache& c = thread_cache();
+            pointer p = c.head;
+            if (p) {
+                c.head = next_spare(p);
+                --c.count;}
+            return p;}
+
+        static pointer take_cached (std::false_type) {
+            return 0;}
+
+        /**
+         * @param p - empty block
+         * @return whether the thread cache had room for p
+         */
+        static bool give_cached (pointer p, std::true_type) {
+            block_cache& c = thread_cache();
+            if (c.count == c.limit)
+                return false;
+            set_next_spare(p, c.head);
+            c.head = p;
+            ++c.count;
+            return true;}
+
+        static bool give_cached (pointer, std::false_type) {
+            return false;}
+
+        /**
+         * @param n - number of blocks the thread cache may hold
+         * frees the cached blocks past the first n
+         */
+        static void limit_cache (size_type n, std::true_type) {
+            block_cache& c = thread_cache();
+            c.limit = n;
+            allocator_type a;
+            while (c.count > n) {
+                pointer p = c.head;
+                c.head = next_spare(p);
+                --c.count;
+                alloc_traits::deallocate(a, p, DEFAULT_ARRAY_SIZE);}}
+
+        static void limit_cache (size_type, std::false_type) {}
+
+        static size_type cache_limit (std::true_type) {
+            return thread_cache().limit;}
+
+        static size_type cache_limit (std::false_type) {
+            return 0;}
+
+        // ----------
+        // next_spare
+        // ----------
+
+        /**
+         * @param p - block on a free list
+         * @return the block after p
+         */
+        static pointer next_spare (pointer p) {
+            pointer n;
+            std::memcpy(&n, static_cast<void*>(p), sizeof(n));
+            return n;}
+
+        /**
+         * @param p - block to link
+         * @param n - block to follow p
+         */
+        static void set_next_spare (pointer p, pointer n) {
+            std::memcpy(static_cast<void*>(p), &n, sizeof(n));}
+
+        // --------------
+        // allocate_block
+        // --------------
+
+        /**
+         * @return an empty block, taken from this deque's free list, then from
+         * the thread cache, then from the allocator
+         */
+        pointer allocate_block () {
+            if (_spare) {
+                pointer p = _spare;
+                _spare = next_spare(p);
+                --_spare_count;
+                return p;}
+            if (pointer p = take_cached(can_cache()))
+                return p;
+            tally(&deque_stats::allocations);
+            return alloc_traits::allocate(_a, DEFAULT_ARRAY_SIZE);}
+
+        // -------------
+        // recycle_block
+        // -------------
+
+        /**
+         * @param p - empty block
+         * keeps p on this deque's free list while it is under its limit,
+         * otherwise gives it away
+         */
+        void recycle_block (pointer p) {
+            if (CAN_RECYCLE && (_spare_count < _spare_limit)) {
+                set_next_spare(p, _spare);
+                _spare = p;
+                ++_spare_count;
+                return;}
+            deallocate_block(p);}
+
+        // ----------------
+        // deallocate_block
+        // ----------------
+
+        /**
+         * @param p     - empty block
+         * @param cache - whether the thread cache may take p
+         * hands p to the thread cache if it may and has room, otherwise
+         * returns it to the allocator
+         */
+        void deallocate_block (pointer p, bool cache = true) {
+            if (cache && give_cached(p, can_cache()))
+                return;
+            tally(&deque_stats::deallocations);
+            alloc_traits::deallocate(_a, p, DEFAULT_ARRAY_SIZE);}
+
+        // -----------
+        // trim_spares
+        // -----------
+
+        /**
+         * @param n     - number of spare blocks to keep
+         * @param cache - whether the thread cache may take them
+         * gives every spare block past the first n away
+         */
+        void trim_spares (size_type n, bool cache = true) {
+            while (_spare_count > n) {
+                pointer p = _spare;
+                _spare = next_spare(p);
+                --_spare_count;
+                deallocate_block(p, cache);}}
+
+        // -----
+        // block
+        // -----
+
+        /**
+         * @param i - slot in the block map
+         * @return the block in slot i, allocating it if the slot is empty
+         */
+        pointer block (size_type i) {
+            if (!_bucket_begin[i])
+                _bucket_begin[i] = allocate_block();
+            return _bucket_begin[i];}
+
+        /**
+         * @param i - slot in the block map
+         * moves the block in slot i to the free list and empties the slot
+         */
+        void release_block (size_type i) {
+            if (_bucket_begin[i]) {
+                recycle_block(_bucket_begin[i]);
+                _bucket_begin[i] = 0;}}
+
+        // ---------
+        // run_begin
+        // ---------
+
+        /**
+         * @return the first slot of the run of allocated blocks that reaches
+         * the first element, spare blocks in front of it included
+         */
+        size_type run_begin () const {
+            size_type i = _offset / DEFAULT_ARRAY_SIZE;
+            while (i && _bucket_begin[i - 1])
+                --i;
+            return i;}
+
+        // -------
+        // run_end
+        // -------
+
+        /**
+         * @return one past the last slot of the run of allocated blocks that
+         * reaches the end position, spare blocks behind it included
+         */
+        size_type run_end () const {
+            size_type i = (_offset + _size) / DEFAULT_ARRAY_SIZE + 1;
+            while ((i != map_size()) && _bucket_begin[i])
+                ++i;
+            return i;}
+
+        // --------------
+        // initialize_map
+        // --------------
+
+        /**
+         * @param n - number of elements the map should have room for
+         * allocates an empty block map with its free slots split evenly
+         * between the two ends, and the block for the end position
+         */
+        void initialize_map (size_type n) {
+            const size_type num_nodes = n / DEFAULT_ARRAY_SIZE + 1;
+            const size_type s         = std::max(DEFAULT_BUCKET_SIZE, num_nodes + 2);
+            tally(&deque_stats::allocations);
+            _bucket_begin = p_a_traits::allocate(_pa, s);
+            _bucket_end   = _bucket_begin + s;
+            std::fill(_bucket_begin, _bucket_end, pointer());
+            _offset = ((s - num_nodes) / 2) * DEFAULT_ARRAY_SIZE;
+            _size   = 0;
+            invalidate_iterators();
+            block(_offset / DEFAULT_ARRAY_SIZE);}
+
+        // --------------
+        // reallocate_map
+        // --------------
+
+        /**
+         * @param nodes_to_add - number of free slots needed at one end
+         * @param at_front - whether the slots are needed before the first block
+         * makes room in the block map by recentring the used slots or by
+         * growing the map, as the growth policy decides
+         * only block pointers move, elements stay where they are, and reserved
+         * blocks next to the elements move with them
+         */
+        void reallocate_map (size_type nodes_to_add, bool at_front) {
+            const size_type first     = run_begin();
+            const size_type last      = run_end() - 1;
+            const size_type old_nodes = last - first + 1;
+            const size_type new_nodes = old_nodes + nodes_to_add;
+            const size_type old_size  = map_size();
+
+            for (size_type i = 0; i < first; ++i)
+                release_block(i);
+            for (size_type i = last + 1; i < old_size; ++i)
+                release_block(i);
+
+            p_p new_start;
+            if ((old_size >= new_nodes) && G::recentre(old_size, new_nodes)) {
+                new_start = _bucket_begin + (old_size - new_nodes) / 2 + (at_front ? nodes_to_add : 0);
+                if (new_start < _bucket_begin + first)
+                    std::copy(_bucket_begin + first, _bucket_begin + last + 1, new_start);
+                else
+                    std::copy_backward(_bucket_begin + first, _bucket_begin + last + 1, new_start + old_nodes);
+                std::fill(_bucket_begin, new_start, pointer());
+                std::fill(new_start + old_nodes, _bucket_end, pointer());}
+            else {
+                const size_type new_size = G::next_size(old_size, new_nodes);
+                assert(new_size >= new_nodes);
+                p_p new_map = p_a_traits::allocate(_pa, new_size);
+                std::fill(new_map, new_map + new_size, pointer());
+                new_start = new_map + (new_size - new_nodes) / 2 + (at_front ? nodes_to_add : 0);
+                std::copy(_bucket_begin + first, _bucket_begin + last + 1, new_start);
+                p_a_traits::deallocate(_pa, _bucket_begin, old_size);
+                tally(&deque_stats::allocations);
+                tally(&deque_stats::deallocations);
+                tally(&deque_stats::growths);
+                _bucket_begin = new_map;
+                _bucket_end   = new_map + new_size;}
+            _offset = (new_start - _bucket_begin) * DEFAULT_ARRAY_SIZE + (_offset - first * DEFAULT_ARRAY_SIZE);
+            invalidate_iterators();
+            assert(valid());}
+
+        // -------------------
+        // reserve_map_at_back
+        // -------------------
+
+        /**
+         * @param n - number of elements
+         * guarantees the block map has slots for n more elements at the back
+         * and for the end position after them
+         */
+        void reserve_map_at_back (size_type n) {
+            if (!_bucket_begin)
+                initialize_map(n);
+            const size_type need = (_offset + _size + n) / DEFAULT_ARRAY_SIZE;
+            if (need >= map_size())
+                reallocate_map(need - (_offset + _size) / DEFAULT_ARRAY_SIZE, false);}
+
+        // --------------------
+        // reserve_map_at_front
+        // --------------------
+
+        /**
+         * @param n - number of elements
+         * guarantees the block map has slots for n more elements at the front
+         */
+        void reserve_map_at_front (size_type n) {
+            if (!_bucket_begin)
+                initialize_map(n);
+            if (n > _offset)
+                reallocate_map((n - _offset % DEFAULT_ARRAY_SIZE + DEFAULT_ARRAY_SIZE - 1) / DEFAULT_ARRAY_SIZE, true);}
+
+        // ----------------------
+        // reserve_blocks_at_back
+        // ----------------------
+
+        /**
+         * @param n - number of elements
+         * allocates every block needed to hold n more elements at the back
+         * blocks that end up unused stay in the map as spares
+         */
+        void reserve_blocks_at_back (size_type n) {
+            reserve_map_at_back(n);
+            const size_type last = (_offset + _size + n) / DEFAULT_ARRAY_SIZE;
+            for (size_type i = (_offset + _size) / DEFAULT_ARRAY_SIZE; i <= last; ++i)
+                block(i);}
+
+        // -----------------------
+        // reserve_blocks_at_front
+        // -----------------------
+
+        /**
+         * @param n - number of elements
+         * allocates every block needed to hold n more elements at the front
+         */
+        void reserve_blocks_at_front (size_type n) {
+            reserve_map_at_front(n);
+            for (size_type i = (_offset - n) / DEFAULT_ARRAY_SIZE; i < _offset / DEFAULT_ARRAY_SIZE; ++i)
+                block(i);}
+
+        // -------------
+        // destroy_range
+        // -------------
+
+        /**
+         * @param i - position of the first element to destroy, counted from block 0
+         * @param j - position one past the last element to destroy
+         * destroys the elements in [i, j) one block at a time
+         */
+        void destroy_range (size_type i, size_type j) {
+            while (i != j) {
+                const size_type k = std::min(j - i, DEFAULT_ARRAY_SIZE - i % DEFAULT_ARRAY_SIZE);
+                pointer p = _bucket_begin[i / DEFAULT_ARRAY_SIZE] + i % DEFAULT_ARRAY_SIZE;
+                destroy(_a, p, p + k);
+                i += k;}}
+
+        // -----------
+        // construct_n
+        // -----------
+
+        /**
+         * @param b - iterator to the first value
+         * @param n - number of values
+         * @param p - storage for n values inside one block
+         * @param move - whether to move the values rather than copy them
+         * @return iterator one past the last value used
+         * on an exception nothing is left constructed
+         */
+        template <typename II>
+        II construct_n (II b, size_type n, pointer p, bool move) {
+            II e = b;
+            std::advance(e, n);
+            tally(move ? &deque_stats::moves : &deque_stats::copies, n);
+            if (move)
+                uninitialized_move(_a, b, e, p);
+            else
+                uninitialized_copy(_a, b, e, p);
+            return e;}
+
+        /**
+         * iterators into a deque are split at the source's own block
+         * boundaries, so each piece goes from pointer to pointer
+         */
+        template <typename DI>
+        DI construct_n (DI b, size_type n, pointer p, bool move, std::true_type) {
+            pointer q = p;
+            tally(move ? &deque_stats::moves : &deque_stats::copies, n);
+            try {
+                while (n) {
+                    const size_type k = std::min<size_type>(n, b._last - b._cur);
+                    if (move)
+                        q = uninitialized_move(_a, b._cur, b._cur + k, q);
+                    else
+                        q = uninitialized_copy(_a, b._cur, b._cur + k, q);
+                    b += k;
+                    n -= k;}}
+            catch (...) {
+                destroy(_a, p, q);
+                throw;}
+            return b;}
+
+        iterator construct_n (iterator b, size_type n, pointer p, bool move) {
+            return construct_n(b, n, p, move, std::true_type());}
+
+        const_iterator construct_n (const_iterator b, size_type n, pointer p, bool move) {
+            return construct_n(b, n, p, move, std::true_type());}
+
+        // --------------------
+        // uninitialized_append
+        // --------------------
+
+        /**
+         * @param b - iterator to the first value to copy
+         * @param n - number of values to copy
+         * copy constructs n values at the back, one block at a time
+         * on an exception the elements already appended are kept
+         */
+        template <typename II>
+        void uninitialized_append (II b, size_type n) {
+            reserve_blocks_at_back(n);
+            while (n) {
+                const size_type k = std::min(n, DEFAULT_ARRAY_SIZE - (_offset + _size) % DEFAULT_ARRAY_SIZE);
+                b = construct_n(b, k, element(_size), false);
+                _size += k;
+                n     -= k;}
+            tally_size();}
+
+        /**
+         * @param b - iterator to the first value to move
+         * @param n - number of values to move
+         * move constructs n values at the back, one block at a time
+         * values whose move constructor may throw are copied instead
+         */
+        template <typename II>
+        void uninitialized_append_move (II b, size_type n) {
+            reserve_blocks_at_back(n);
+            while (n) {
+                const size_type k = std::min(n, DEFAULT_ARRAY_SIZE - (_offset + _size) % DEFAULT_ARRAY_SIZE);
+                b = construct_n(b, k, element(_size), true);
+                _size += k;
+                n     -= k;}
+            tally_size();}
+
+        /**
+         * @param n - number of values to fill
+         * @param v - value to fill with
+         * copy constructs n copies of v at the back, one block at a time
+         */
+        void uninitialized_append (size_type n, const_reference v) {
+            reserve_blocks_at_back(n);
+            while (n) {
+                const size_type k = std::min(n, DEFAULT_ARRAY_SIZE - (_offset + _size) % DEFAULT_ARRAY_SIZE);
+                pointer p = element(_size);
+                uninitialized_fill(_a, p, p + k, v);
+                tally(&deque_stats::copies, k);
+                _size += k;
+                n     -= k;}
+            tally_size();}
+
+        // ---------------------
+        // uninitialized_prepend
+        // ---------------------
+
+        /**
+         * @param b - iterator to the first value to copy
+         * @param n - number of values to copy
+         * copy constructs n values in front of the first element, keeping
+         * their order, one block at a time
+         * on an exception nothing is prepended
+         */
+        template <typename II>
+        void uninitialized_prepend (II b, size_type n) {
+            reserve_blocks_at_front(n);
+            const size_type start = _offset - n;
+            size_type i = start;
+            try {
+                while (i != _offset) {
+                    const size_type k = std::min(_offset - i, DEFAULT_ARRAY_SIZE - i % DEFAULT_ARRAY_SIZE);
+                    b = construct_n(b, k, _bucket_begin[i / DEFAULT_ARRAY_SIZE] + i % DEFAULT_ARRAY_SIZE, false);
+                    i += k;}}
+            catch (...) {
+                destroy_range(start, i);
+                throw;}
+            _offset = start;
+            _size  += n;
+            tally_size();}
+
+        /**
+         * @param n - number of values to fill
+         * @param v - value to fill with
+         * copy constructs n copies of v in front of the first element
+         * on an exception nothing is prepended
+         */
+        void uninitialized_prepend (size_type n, const_reference v) {
+            reserve_blocks_at_front(n);
+            const size_type start = _offset - n;
+            size_type i = start;
+            tally(&deque_stats::copies, n);
+            try {
+                while (i != _offset) {
+                    const size_type k = std::min(_offset - i, DEFAULT_ARRAY_SIZE - i % DEFAULT_ARRAY_SIZE);
+                    pointer p = _bucket_begin[i / DEFAULT_ARRAY_SIZE] + i % DEFAULT_ARRAY_SIZE;
+                    uninitialized_fill(_a, p, p + k, v);
+                    i += k;}}
+            catch (...) {
+                destroy_range(start, i);
+                throw;}
+            _offset = start;
+            _size  += n;
+            tally_size();}
+
+        // --------------
+        // erase_at_front
+        // --------------
+
+        /**
+         * @param n - number of elements
+         * destroys the first n elements and releases the blocks they emptied
+         */
+        void erase_at_front (size_type n) {
+            destroy_range(_offset, _offset + n);
+            for (size_type i = _offset / DEFAULT_ARRAY_SIZE; i < (_offset + n) / DEFAULT_ARRAY_SIZE; ++i)
+                release_block(i);
+            _offset += n;
+            _size   -= n;}
+
+        // -------------
+        // erase_at_back
+        // -------------
+
+        /**
+         * @param n - number of elements
+         * destroys the last n elements and releases the blocks they emptied
+         */
+        void erase_at_back (size_type n) {
+            const size_type j = _offset + _size;
+            destroy_range(j - n, j);
+            for (size_type i = (j - n) / DEFAULT_ARRAY_SIZE + 1; i <= j / DEFAULT_ARRAY_SIZE; ++i)
+                release_block(i);
+            _size -= n;}
+
+        // ------------
+        // append_range
+        // ------------
+
+        /**
+         * @param b - input iterator to the first value
+         * @param e - input iterator one past the last value
+         * appends [b, e) one element at a time, the length is not known ahead
+         */
+        template <typename II>
+        void append_range (II b, II e, std::input_iterator_tag) {
+            while (b != e) {
+                push_back(*b);
+                ++b;}}
+
+        /**
+         * @param b - forward iterator to the first value
+         * @param e - forward iterator one past the last value
+         * appends [b, e) after sizing the block map once
+         */
+        template <typename FI>
+        void append_range (FI b, FI e, std::forward_iterator_tag) {
+            uninitialized_append(b, std::distance(b, e));}
+
+        // ------------
+        // insert_range
+        // ------------
+
+        /**
+         * @param i - index to insert at
+         * @param b - input iterator to the first value
+         * @param e - input iterator one past the last value
+         * appends [b, e) and rotates it into place
+         */
+        template <typename II>
+        void insert_range (size_type i, II b, II e, std::input_iterator_tag) {
+            const size_type s = size();
+            append_range(b, e, std::input_iterator_tag());
+            iterator x = begin();
+            tally(&deque_stats::moves, size() - i);
+            std::rotate(x + i, x + s, end());}
+
+        /**
+         * @param i - index to insert at
+         * @param b - forward iterator to the first value
+         * @param e - forward iterator one past the last value
+         * constructs [b, e) at the nearer end and rotates it into place
+         */
+        template <typename FI>
+        void insert_range (size_type i, FI b, FI e, std::forward_iterator_tag) {
+            const size_type n = std::distance(b, e);
+            const size_type s = size();
+            if (i < s - i) {
+                uninitialized_prepend(b, n);
+                iterator x = begin();
+                tally(&deque_stats::moves, n + i);
+                std::rotate(x, x + n, x + (n + i));}
+            else {
+                uninitialized_append(b, n);
+                iterator x = begin();
+                tally(&deque_stats::moves, size() - i);
+                std::rotate(x + i, x + s, end());}}
+
+        // -------------
+        // stream_header
+        // -------------
+
+        deque_stream_header stream_header () const {
+            deque_stream_header h;
+            h.magic        = deque_stream_header::MAGIC;
+            h.element_size = sizeof(T);
+            h.count        = _size;
+            return h;}
+
+        /**
+         * @param h - header just read
+         * @return whether the elements behind it are T
+         */
+        static bool stream_header_fits (const deque_stream_header& h) {
+            return (h.magic == deque_stream_header::MAGIC) && (h.element_size == sizeof(T));}
+
+#if DEQUE_GATHER_IO
+#ifdef IOV_MAX
+        static const int IO_VECTORS = IOV_MAX;
+#else
+        static const int IO_VECTORS = 16;
+#endif
+
+        // ------
+        // gather
+        // ------
+
+        /**
+         * @param i - index of the first element not yet transferred in full
+         * @param r - bytes of element i already transferred
+         * @param n - number of elements from i on
+         * @param v - room for m vectors
+         * @param m - most vectors to fill
+         * @return number of vectors filled, one per block, covering as much
+         * of what is left as fits
+         */
+        int gather (size_type i, std::size_t r, size_type n, iovec* v, int m) const {
+            int c = 0;
+            while (n && (c != m)) {
+                const size_type k = std::min(n, DEFAULT_ARRAY_SIZE - (_offset + i) % DEFAULT_ARRAY_SIZE);
+                v[c].iov_base = reinterpret_cast<char*>(&*element(i)) + r;
+                v[c].iov_len  = k * sizeof(T) - r;
+                r  = 0;
+                i += k;
+                n -= k;
+                ++c;}
+            return c;}
+#endif
+
+        // -------
+        // release
+        // -------
+
+        /**
+         * @param cache - whether the thread cache may take the blocks
+         * destroys every element and gives every block, spares included, away
+         * and returns the map to the allocator
+         */
+        void release (bool cache = true) {
+            if (_bucket_begin) {
+                destroy_range(_offset, _offset + _size);
+                for (size_type i = 0; i < map_size(); ++i)
+                    if (_bucket_begin[i])
+                        deallocate_block(_bucket_begin[i], cache);
+                tally(&deque_stats::deallocations);
+                p_a_traits::deallocate(_pa, _bucket_begin, map_size());
+                _bucket_begin = _bucket_end = 0;
+                _offset = _size = 0;
+                invalidate_iterators();}
+            trim_spares(0, cache);}
+
+        // ------------
+        // take_storage
+        // ------------
+
+        /**
+         * @param that - deque whose blocks this can free
+         * takes over the map, blocks and spares of that, leaving it empty
+         * this must already be released
+         */
+        void take_storage (my_deque& that) {
+            _bucket_begin = that._bucket_begin;
+            _bucket_end   = that._bucket_end;
+            _offset       = that._offset;
+            _size         = that._size;
+            _spare        = that._spare;
+            _spare_count  = that._spare_count;
+            _spare_limit  = that._spare_limit;
+            that._bucket_begin = that._bucket_end = 0;
+            that._offset = that._size = 0;
+            that._spare = 0;
+            that._spare_count = 0;
+            invalidate_iterators();
+            that.invalidate_iterators();}
+
+        // ----------------
+        // adopt_allocators
+        // ----------------
+
+        /**
+         * @param that - deque whose allocator propagates to this
+         * the tag says whether the allocator propagates at all
+         */
+        void adopt_allocators (const my_deque& that, std::true_type) {
+            _a  = that._a;
+            _pa = p_a_t(_a);}
+
+        void adopt_allocators (const my_deque&, std::false_type) {}
+
+        /**
+         * @param that - deque whose allocators swap with this one's
+         * the tag says whether the allocator propagates on swap, when it does
+         * not the allocators must already be equal
+         */
+        void swap_allocators (my_deque& that, std::true_type) noexcept {
+            using std::swap;
+            swap(_a,  that._a);
+            swap(_pa, that._pa);}
+
+        void swap_allocators (my_deque& that, std::false_type) noexcept {
+            assert(_a == that._a);
+            (void)that;}
+
+        // -----------
+        // move_assign
+        // -----------
+
+        /**
+         * @param rhs - deque to move from
+         * the allocator propagates, so this frees its blocks and takes over rhs
+         */
+        void move_assign (my_deque& rhs, std::true_type) {
+            release();
+            _a  = std::move(rhs._a);
+            _pa = p_a_t(_a);
+            take_storage(rhs);}
 
+        /**
+         * @param rhs - deque to move from
+         * the allocator stays, so only blocks this can free are taken over,
+         * otherwise the elements move one by one into this deque's blocks
+         */
+        void move_assign (my_deque& rhs, std::false_type) {
+            if (_a == rhs._a) {
+                release();
+                take_storage(rhs);}
+            else {
+                clear();
+                uninitialized_append_move(rhs.begin(), rhs.size());}}
 
     public:
         // --------
         // iterator
         // --------
 
-        class iterator {
+        class iterator : public segmented_algorithms<my_deque, iterator> {
+            friend class my_deque;
+
             public:
                 // --------
                 // typedefs
                 // --------
 
-                typedef std::bidirectional_iterator_tag   iterator_category;
+                typedef std::random_access_iterator_tag   iterator_category;
                 typedef typename my_deque::value_type      value_type;
                 typedef typename my_deque::difference_type difference_type;
                 typedef typename my_deque::pointer         pointer;
@@ -204,11 +1634,11 @@ class my_deque {
                  * @param lhs - deque constant iterator for lhs of operation
                  * @param rhs - deque constant iterator for rhs of operation
                  * @return bool
-                 * returns boolean indicating if the iterators iterate over the same
-                 * containers
+                 * returns boolean indicating if the iterators point at the same
+                 * element
                  */
                 friend bool operator == (const iterator& lhs, const iterator& rhs) {
-                    return lhs._c == rhs._c && lhs.index == rhs.index;
+                    return lhs._cur == rhs._cur;
                 }
 
                 /**
@@ -221,6 +1651,28 @@ class my_deque {
                 friend bool operator != (const iterator& lhs, const iterator& rhs) {
                     return !(lhs == rhs);}
 
+                // ----------
+                // operator <
+                // ----------
+
+                /**
+                 * @param lhs - iterator for lhs of operation
+                 * @param rhs - iterator for rhs of operation
+                 * @return bool
+                 * returns boolean indicating if lhs comes before rhs
+                 */
+                friend bool operator < (const iterator& lhs, const iterator& rhs) {
+                    return (lhs._node == rhs._node) ? (lhs._cur < rhs._cur) : (lhs._node < rhs._node);}
+
+                friend bool operator > (const iterator& lhs, const iterator& rhs) {
+                    return rhs < lhs;}
+
+                friend bool operator <= (const iterator& lhs, const iterator& rhs) {
+                    return !(rhs < lhs);}
+
+                friend bool operator >= (const iterator& lhs, const iterator& rhs) {
+                    return !(lhs < rhs);}
+
                 // ----------
                 // operator +
                 // ----------
@@ -234,6 +1686,9 @@ class my_deque {
                 friend iterator operator + (iterator lhs, difference_type rhs) {
                     return lhs += rhs;}
 
+                friend iterator operator + (difference_type lhs, iterator rhs) {
+                    return rhs += lhs;}
+
                 // ----------
                 // operator -
                 // ----------
@@ -247,13 +1702,54 @@ class my_deque {
                 friend iterator operator - (iterator lhs, difference_type rhs) {
                     return lhs -= rhs;}
 
+                /**
+                 * @param lhs - deque iterator
+                 * @param rhs - deque iterator
+                 * @return difference_type
+                 * returns the number of elements from rhs to lhs
+                 */
+                friend difference_type operator - (const iterator& lhs, const iterator& rhs) {
+                    lhs.check();
+                    rhs.check();
+                    return difference_type(DEFAULT_ARRAY_SIZE) * (lhs._node - rhs._node) +
+                           (lhs._cur - lhs._first) - (rhs._cur - rhs._first);}
+
             private:
                 // ----
                 // data
                 // ----
 
-                my_deque* _c;
-                size_type index;
+                pointer _cur;       // current element
+                pointer _first;     // bounds of the current block
+                pointer _last;
+                p_p     _node;      // slot of the current block in the map
+
+#if DEQUE_DEBUG
+                const my_deque* _owner;       // deque the iterator came from
+                size_type       _generation;  // its generation then
+#endif
+
+            private:
+                // -----
+                // check
+                // -----
+
+                /**
+                 * aborts when the iterator is singular, when the deque has moved
+                 * its map since the iterator was made, or when the deque has
+                 * freed the block it points into, with DEQUE_DEBUG on
+                 */
+#if DEQUE_DEBUG
+                void check () const {
+                    if (!_owner)
+                        deque_debug_failure("my_deque: singular iterator used");
+                    if (_owner->_generation != _generation)
+                        deque_debug_failure("my_deque: iterator used after the deque reallocated");
+                    if (_node && ((_node < _owner->_bucket_begin) || (_node >= _owner->_bucket_end) || (*_node != _first)))
+                        deque_debug_failure("my_deque: iterator used after its block was freed");}
+#else
+                void check () const {}
+#endif
 
             private:
                 // -----
@@ -261,22 +1757,53 @@ class my_deque {
                 // -----
 
                 bool valid () const {
-                    return index >= 0;}
+                    return (!_node && !_cur) || ((_first <= _cur) && (_cur < _last));}
+
+                // --------
+                // set_node
+                // --------
+
+                /**
+                 * @param n - slot in the block map
+                 * moves the cached block bounds to the block in n
+                 */
+                void set_node (p_p n) {
+                    _node  = n;
+                    _first = *n;
+                    _last  = _first + DEFAULT_ARRAY_SIZE;}
 
             public:
                 // -----------
                 // constructor
                 // -----------
 
+                /**
+                 * constructs a singular iterator, which may only be assigned to,
+                 * copied or compared with another singular iterator
+                 */
+                iterator () : _cur(0), _first(0), _last(0), _node(0){
+#if DEQUE_DEBUG
+                    _owner      = 0;
+                    _generation = 0;
+#endif
+                }
+
                 /**
                  * @param c - pointer to deque
                  * @param i - index to start at
                  * constructs iterator for deque c at position i
                  */
-                iterator (my_deque* c, size_type i = 0) : _c(c), index(0){
-
-                    index = i;
-
+                iterator (my_deque* c, size_type i = 0) : _cur(0), _first(0), _last(0), _node(0){
+                    if (c->_bucket_begin) {
+                        const size_type j = c->_offset + i;
+                        _node  = c->_bucket_begin + j / DEFAULT_ARRAY_SIZE;
+                        _first = *_node;
+                        _last  = _first + DEFAULT_ARRAY_SIZE;
+                        _cur   = _first + j % DEFAULT_ARRAY_SIZE;}
+#if DEQUE_DEBUG
+                    _owner      = c;
+                    _generation = c->_generation;
+#endif
                     assert(valid());
                 }
 
@@ -295,7 +1822,8 @@ class my_deque {
                  * returns a dereference for iterator
                  */
                 reference operator * () const {
-                    return (*_c)[index];}
+                    check();
+                    return *_cur;}
 
                 // -----------
                 // operator ->
@@ -304,10 +1832,23 @@ class my_deque {
                 /**
                  * @param deque
                  * @return pointer
-                 * returns pointer to item at deque[0]
+                 * returns pointer to the current element
                  */
                 pointer operator -> () const {
-                    return &**this;}
+                    check();
+                    return _cur;}
+
+                // -----------
+                // operator []
+                // -----------
+
+                /**
+                 * @param n - offset from this iterator
+                 * @return reference
+                 * returns a reference to the element n positions away
+                 */
+                reference operator [] (difference_type n) const {
+                    return *(*this + n);}
 
                 // -----------
                 // operator ++
@@ -319,8 +1860,10 @@ class my_deque {
                  * pre-increments an iterator
                  */
                 iterator& operator ++ () {
-                    // ++(*this);
-                    ++index;
+                    check();
+                    if (++_cur == _last) {
+                        set_node(_node + 1);
+                        _cur = _first;}
                     assert(valid());
                     return *this;}
 
@@ -345,8 +1888,11 @@ class my_deque {
                  * pre-decrements iterator
                  */
                 iterator& operator -- () {
-                    // --(*this);
-                    --index;
+                    check();
+                    if (_cur == _first) {
+                        set_node(_node - 1);
+                        _cur = _last;}
+                    --_cur;
                     assert(valid());
                     return *this;}
 
@@ -370,10 +1916,18 @@ class my_deque {
                  * @param d - value to add to iterator
                  * @return iterator reference to new position
                  * adds d to iterator and returns a reference to new iterator
+                 * only touches the block map when d leaves the current block
                  */
                 iterator& operator += (difference_type d) {
-                    index += d;
-                    // *this = *this + d;
+                    check();
+                    const difference_type b      = DEFAULT_ARRAY_SIZE;
+                    const difference_type offset = d + (_cur - _first);
+                    if ((offset >= 0) && (offset < b))
+                        _cur += d;
+                    else {
+                        const difference_type node_offset = (offset > 0) ? offset / b : -((-offset - 1) / b) - 1;
+                        set_node(_node + node_offset);
+                        _cur = _first + (offset - node_offset * b);}
                     assert(valid());
                     return *this;}
 
@@ -388,22 +1942,22 @@ class my_deque {
                  * subtracts d from iterator and returns reference to it
                  */
                 iterator& operator -= (difference_type d) {
-                    index -= d;
-                    assert(valid());
-                    return *this;}};
+                    return *this += -d;}};
 
     public:
         // --------------
         // const_iterator
         // --------------
 
-        class const_iterator {
+        class const_iterator : public segmented_algorithms<my_deque, const_iterator> {
+            friend class my_deque;
+
             public:
                 // --------
                 // typedefs
                 // --------
 
-                typedef std::bidirectional_iterator_tag   iterator_category;
+                typedef std::random_access_iterator_tag   iterator_category;
                 typedef typename my_deque::value_type      value_type;
                 typedef typename my_deque::difference_type difference_type;
                 typedef typename my_deque::const_pointer   pointer;
@@ -418,10 +1972,10 @@ class my_deque {
                  * @param lhs - constant iterator left hand side of operation
                  * @param rhs - constant iterator right hand side of operation
                  * @return bool
-                 * returns whether two iterators iterate over same container
+                 * returns whether two iterators point at the same element
                  */
                 friend bool operator == (const const_iterator& lhs, const const_iterator& rhs) {
-                    return lhs._c == rhs._c && lhs.index == rhs.index;}
+                    return lhs._cur == rhs._cur;}
 
                 /**
                  * @param lhs - constant iterator left hand side of operation
@@ -432,6 +1986,28 @@ class my_deque {
                 friend bool operator != (const const_iterator& lhs, const const_iterator& rhs) {
                     return !(lhs == rhs);}
 
+                // ----------
+                // operator <
+                // ----------
+
+                /**
+                 * @param lhs - constant iterator left hand side of operation
+                 * @param rhs - constant iterator right hand side of operation
+                 * @return bool
+                 * returns whether lhs comes before rhs
+                 */
+                friend bool operator < (const const_iterator& lhs, const const_iterator& rhs) {
+                    return (lhs._node == rhs._node) ? (lhs._cur < rhs._cur) : (lhs._node < rhs._node);}
+
+                friend bool operator > (const const_iterator& lhs, const const_iterator& rhs) {
+                    return rhs < lhs;}
+
+                friend bool operator <= (const const_iterator& lhs, const const_iterator& rhs) {
+                    return !(rhs < lhs);}
+
+                friend bool operator >= (const const_iterator& lhs, const const_iterator& rhs) {
+                    return !(lhs < rhs);}
+
                 // ----------
                 // operator +
                 // ----------
@@ -445,6 +2021,9 @@ class my_deque {
                 friend const_iterator operator + (const_iterator lhs, difference_type rhs) {
                     return lhs += rhs;}
 
+                friend const_iterator operator + (difference_type lhs, const_iterator rhs) {
+                    return rhs += lhs;}
+
                 // ----------
                 // operator -
                 // ----------
@@ -458,15 +2037,54 @@ class my_deque {
                 friend const_iterator operator - (const_iterator lhs, difference_type rhs) {
                     return lhs -= rhs;}
 
+                /**
+                 * @param lhs - const_iterator
+                 * @param rhs - const_iterator
+                 * @return difference_type
+                 * returns the number of elements from rhs to lhs
+                 */
+                friend difference_type operator - (const const_iterator& lhs, const const_iterator& rhs) {
+                    lhs.check();
+                    rhs.check();
+                    return difference_type(DEFAULT_ARRAY_SIZE) * (lhs._node - rhs._node) +
+                           (lhs._cur - lhs._first) - (rhs._cur - rhs._first);}
+
             private:
                 // ----
                 // data
                 // ----
 
-                // <your data>
+                const_pointer _cur;     // current element
+                const_pointer _first;   // bounds of the current block
+                const_pointer _last;
+                p_p           _node;    // slot of the current block in the map
 
-                const my_deque* _c;
-                size_type index;
+#if DEQUE_DEBUG
+                const my_deque* _owner;       // deque the iterator came from
+                size_type       _generation;  // its generation then
+#endif
+
+            private:
+                // -----
+                // check
+                // -----
+
+                /**
+                 * aborts when the iterator is singular, when the deque has moved
+                 * its map since the iterator was made, or when the deque has
+                 * freed the block it points into, with DEQUE_DEBUG on
+                 */
+#if DEQUE_DEBUG
+                void check () const {
+                    if (!_owner)
+                        deque_debug_failure("my_deque: singular iterator used");
+                    if (_owner->_generation != _generation)
+                        deque_debug_failure("my_deque: iterator used after the deque reallocated");
+                    if (_node && ((_node < _owner->_bucket_begin) || (_node >= _owner->_bucket_end) || (*_node != _first)))
+                        deque_debug_failure("my_deque: iterator used after its block was freed");}
+#else
+                void check () const {}
+#endif
 
             private:
                 // -----
@@ -474,21 +2092,63 @@ class my_deque {
                 // -----
 
                 bool valid () const {
-                    return index >= 0;}
+                    return (!_node && !_cur) || ((_first <= _cur) && (_cur < _last));}
+
+                // --------
+                // set_node
+                // --------
+
+                /**
+                 * @param n - slot in the block map
+                 * moves the cached block bounds to the block in n
+                 */
+                void set_node (p_p n) {
+                    _node  = n;
+                    _first = *n;
+                    _last  = _first + DEFAULT_ARRAY_SIZE;}
 
             public:
                 // -----------
                 // constructor
                 // -----------
 
+                /**
+                 * construct a singular const_iterator
+                 */
+                const_iterator () : _cur(0), _first(0), _last(0), _node(0){
+#if DEQUE_DEBUG
+                    _owner      = 0;
+                    _generation = 0;
+#endif
+                }
+
                 /**
                  * @param deque c
                  * @param index i
                  * construct a const_iterator for c starting at i
                  */
-                const_iterator  (const my_deque* c, size_type i = 0) : _c(c), index(0){
+                const_iterator (const my_deque* c, size_type i = 0) : _cur(0), _first(0), _last(0), _node(0){
+                    if (c->_bucket_begin) {
+                        const size_type j = c->_offset + i;
+                        _node  = c->_bucket_begin + j / DEFAULT_ARRAY_SIZE;
+                        _first = *_node;
+                        _last  = _first + DEFAULT_ARRAY_SIZE;
+                        _cur   = _first + j % DEFAULT_ARRAY_SIZE;}
+#if DEQUE_DEBUG
+                    _owner      = c;
+                    _generation = c->_generation;
+#endif
+                    assert(valid());}
 
-                    index = i;
+                /**
+                 * @param rhs - iterator
+                 * construct a const_iterator at the same position as rhs
+                 */
+                const_iterator (const iterator& rhs) : _cur(rhs._cur), _first(rhs._first), _last(rhs._last), _node(rhs._node){
+#if DEQUE_DEBUG
+                    _owner      = rhs._owner;
+                    _generation = rhs._generation;
+#endif
                     assert(valid());}
 
                 // Default copy, destructor, and copy assignment.
@@ -506,8 +2166,8 @@ class my_deque {
                  * dereferences const_iterator
                  */
                 reference operator * () const {
-                   
-                    return (*_c)[index];}
+                    check();
+                    return *_cur;}
 
                 // -----------
                 // operator ->
@@ -516,10 +2176,23 @@ class my_deque {
                 /**
                  * @param const_iterator
                  * @return pointer
-                 * returns pointer to beginning of deque
+                 * returns pointer to the current element
+                 */
+                pointer operator -> () const {
+                    check();
+                    return _cur;}
+
+                // -----------
+                // operator []
+                // -----------
+
+                /**
+                 * @param n - offset from this iterator
+                 * @return reference
+                 * returns a constant reference to the element n positions away
                  */
-                pointer operator -> () const {
-                    return &**this;}
+                reference operator [] (difference_type n) const {
+                    return *(*this + n);}
 
                 // -----------
                 // operator ++
@@ -531,7 +2204,10 @@ class my_deque {
                  * pre-increments const_iterator
                  */
                 const_iterator& operator ++ () {
-                    ++index;
+                    check();
+                    if (++_cur == _last) {
+                        set_node(_node + 1);
+                        _cur = _first;}
                     assert(valid());
                     return *this;}
 
@@ -556,7 +2232,11 @@ class my_deque {
                  * pre-decrements const_iterator
                  */
                 const_iterator& operator -- () {
-                    --index;
+                    check();
+                    if (_cur == _first) {
+                        set_node(_node - 1);
+                        _cur = _last;}
+                    --_cur;
                     assert(valid());
                     return *this;}
 
@@ -580,10 +2260,18 @@ class my_deque {
                  * @param value d
                  * @return const_iterator reference
                  * adds d to iterator
+                 * only touches the block map when d leaves the current block
                  */
                 const_iterator& operator += (difference_type d) {
-
-                    index += d;
+                    check();
+                    const difference_type b      = DEFAULT_ARRAY_SIZE;
+                    const difference_type offset = d + (_cur - _first);
+                    if ((offset >= 0) && (offset < b))
+                        _cur += d;
+                    else {
+                        const difference_type node_offset = (offset > 0) ? offset / b : -((-offset - 1) / b) - 1;
+                        set_node(_node + node_offset);
+                        _cur = _first + (offset - node_offset * b);}
                     assert(valid());
                     return *this;}
 
@@ -598,9 +2286,102 @@ class my_deque {
                  * subtracts d from iterator
                  */
                 const_iterator& operator -= (difference_type d) {
-                    index -= d
-                    assert(valid());
-                    return *this;}};
+                    return *this += -d;}};
+
+        // ------------
+        // segment_view
+        // ------------
+
+        /**
+         * the elements of [b, e) as a forward range of segments, one for each
+         * block the range touches, in order
+         */
+        template <typename I>
+        class segment_view {
+            public:
+                typedef segment<typename I::pointer> segment_type;
+
+                class iterator {
+                    private:
+                        I            _b;
+                        I            _e;
+                        segment_type _s;
+
+                        segment_type current () const {
+                            if (_b == _e)
+                                return segment_type(0, 0);
+                            return segment_type(_b._cur, std::min<difference_type>(_e - _b, _b._last - _b._cur));}
+
+                    public:
+                        typedef std::forward_iterator_tag iterator_category;
+                        typedef segment_type              value_type;
+                        typedef std::ptrdiff_t            difference_type;
+                        typedef const segment_type*       pointer;
+                        typedef const segment_type&       reference;
+
+                        iterator (I b, I e) :
+                                _b(b), _e(e), _s(current()) {}
+
+                        friend bool operator == (const iterator& lhs, const iterator& rhs) {
+                            return lhs._b == rhs._b;}
+
+                        friend bool operator != (const iterator& lhs, const iterator& rhs) {
+                            return !(lhs == rhs);}
+
+                        reference operator * () const {
+                            return _s;}
+
+                        pointer operator -> () const {
+                            return &_s;}
+
+                        iterator& operator ++ () {
+                            _b += _s.count;
+                            _s  = current();
+                            return *this;}
+
+                        iterator operator ++ (int) {
+                            iterator x = *this;
+                            ++*this;
+                            return x;}};
+
+            private:
+                I _b;
+                I _e;
+
+            public:
+                segment_view (I b, I e) :
+                        _b(b), _e(e) {}
+
+                iterator begin () const {
+                    return iterator(_b, _e);}
+
+                iterator end () const {
+                    return iterator(_e, _e);}};
+
+        // ------------
+        // copy_segment
+        // ------------
+
+        /**
+         * @param b - pointer to the first value of a segment
+         * @param e - pointer one past the last value
+         * @param x - output iterator
+         * @return x advanced past the copies
+         * a deque iterator as x is split at its own blocks, so every piece is
+         * a copy from pointer to pointer
+         */
+        template <typename P, typename OI>
+        static OI copy_segment (P b, P e, OI x) {
+            return std::copy(b, e, x);}
+
+        template <typename P>
+        static iterator copy_segment (P b, P e, iterator x) {
+            while (b != e) {
+                const difference_type k = std::min<difference_type>(e - b, x._last - x._cur);
+                std::copy(b, b + k, x._cur);
+                b += k;
+                x += k;}
+            return x;}
 
     public:
         // ------------
@@ -613,7 +2394,7 @@ class my_deque {
          */
          //default size
         explicit my_deque (const allocator_type& a = allocator_type())
-        : _a(a), _pa(), _bucket_begin(0), _bucket_end(0), _inner_begin(0), _data_begin(0), _data_end(0), _inner_end(0){
+        : _a(a), _pa(_a), _bucket_begin(0), _bucket_end(0), _offset(0), _size(0), _spare(0), _spare_count(0), _spare_limit(DEFAULT_SPARE_BLOCKS){
 
         assert(valid() );}
 
@@ -625,21 +2406,44 @@ class my_deque {
          */
          // given size
         explicit my_deque (size_type s, const_reference v = value_type(), const allocator_type& a = allocator_type())
-        :_a(a), _pa(){
-
-            size_type num_arrays = s / DEFAULT_ARRAY_SIZE + (s % DEFAULT_ARRAY_SIZE? 1 : 0);
-            _bucket_begin = _pa.allocate(num_arrays);
-            for (size_type i = 0; i < num_arrays; ++i) {
-                _bucket_begin[i] = _a.allocate(DEFAULT_ARRAY_SIZE);
-            }
+        :_a(a), _pa(_a), _bucket_begin(0), _bucket_end(0), _offset(0), _size(0), _spare(0), _spare_count(0), _spare_limit(DEFAULT_SPARE_BLOCKS){
+            try {
+                uninitialized_append(s, v);}
+            catch (...) {
+                release();
+                throw;}
+            assert(valid());}
 
-            _bucket_end = _bucket_begin + num_arrays;
-            size_type offset = DEFAULT_ARRAY_SIZE - (DEFAULT_ARRAY_SIZE * num_arrays - s); 
-            _inner_begin = _data_begin = _a.allocate(num_arrays * DEFAULT_ARRAY_SIZE);
-            _inner_end = _inner_begin + (num_arrays * DEFAULT_ARRAY_SIZE);
-            _data_end = _data_begin + s;
-            uninitialized_fill(_a, _data_begin, _data_end, v);
+        /**
+         * @param b - iterator to the first value
+         * @param e - iterator one past the last value
+         * @param a - allocator - defaulted
+         * constructs deque holding a copy of [b, e)
+         * forward iterators size the block map once
+         */
+        template <typename II>
+        my_deque (II b, II e, const allocator_type& a = allocator_type(),
+                  typename std::enable_if<!std::is_integral<II>::value>::type* = 0)
+        :_a(a), _pa(_a), _bucket_begin(0), _bucket_end(0), _offset(0), _size(0), _spare(0), _spare_count(0), _spare_limit(DEFAULT_SPARE_BLOCKS){
+            try {
+                append_range(b, e);}
+            catch (...) {
+                release();
+                throw;}
+            assert(valid());}
 
+        /**
+         * @param l - list of values
+         * @param a - allocator - defaulted
+         * constructs deque holding a copy of l
+         */
+        my_deque (std::initializer_list<value_type> l, const allocator_type& a = allocator_type())
+        :_a(a), _pa(_a), _bucket_begin(0), _bucket_end(0), _offset(0), _size(0), _spare(0), _spare_count(0), _spare_limit(DEFAULT_SPARE_BLOCKS){
+            try {
+                uninitialized_append(l.begin(), l.size());}
+            catch (...) {
+                release();
+                throw;}
             assert(valid());}
 
         /**
@@ -649,26 +2453,55 @@ class my_deque {
          */
          //copy constructor
         my_deque (const my_deque& that) 
-            : _a(that._a), _pa(that._pa),  _bucket_begin(0), _bucket_end(0), _inner_begin(0), _data_begin(0), _data_end(0), _inner_end(0){
-
-
-            _bucket_begin = _bucket_end = 0;
-            _inner_begin = _data_begin = _a.allocate(that.size());
-            _data_end = _data_begin + that.size();
-            _inner_end = _inner_begin + (that._inner_end - that._inner_begin);
-            uninitialized_copy(_a, that._data_begin, that._data_end, _data_begin);
- 
-        }
-
+            : _a(alloc_traits::select_on_container_copy_construction(that._a)), _pa(_a), _bucket_begin(0), _bucket_end(0), _offset(0), _size(0), _spare(0), _spare_count(0), _spare_limit(that._spare_limit){
+            try {
+                uninitialized_append(that.begin(), that.size());}
+            catch (...) {
+                release();
+                throw;}
+            assert(valid());}
 
+        /**
+         * @param that - deque to copy
+         * @param s - number of elements to make room for at the back
+         * deep copies that to this with slots in the block map for s elements
+         */
+        my_deque(const my_deque& that, size_type s)
+            : _a(alloc_traits::select_on_container_copy_construction(that._a)), _pa(_a), _bucket_begin(0), _bucket_end(0), _offset(0), _size(0), _spare(0), _spare_count(0), _spare_limit(that._spare_limit){
+            try {
+                reserve_map_at_back(std::max(s, that.size()));
+                uninitialized_append(that.begin(), that.size());}
+            catch (...) {
+                release();
+                throw;}
+            assert(valid());}
 
+        /**
+         * @param that - deque to move from
+         * takes over the blocks of that, leaving it empty
+         */
+        my_deque (my_deque&& that) noexcept
+            : _a(std::move(that._a)), _pa(_a), _bucket_begin(0), _bucket_end(0), _offset(0), _size(0), _spare(0), _spare_count(0), _spare_limit(that._spare_limit){
+            take_storage(that);
+            assert(valid());}
 
-        my_deque(const my_deque& that, size_type s): _a(that._a), _pa(that._pa){
-            _bucket_begin = _bucket_end = 0;
-            _inner_begin = _data_begin = _a.allocate(s);
-            _data_end = _inner_end = _data_begin + s;
-            uninitialized_copy(_a, that._data_begin, that._data_end, _data_begin);
-        }
+        /**
+         * @param that - deque to move from
+         * @param a - allocator for this deque
+         * takes over the blocks of that when a can free them, otherwise
+         * moves the elements one by one into blocks from a
+         */
+        my_deque (my_deque&& that, const allocator_type& a)
+            : _a(a), _pa(_a), _bucket_begin(0), _bucket_end(0), _offset(0), _size(0), _spare(0), _spare_count(0), _spare_limit(DEFAULT_SPARE_BLOCKS){
+            if (_a == that._a) {
+                swap(that);
+                return;}
+            try {
+                uninitialized_append_move(that.begin(), that.size());}
+            catch (...) {
+                release();
+                throw;}
+            assert(valid());}
 
         // ----------
         // destructor
@@ -678,12 +2511,8 @@ class my_deque {
          * Destroys this deque and frees up all memory used
          */
         ~my_deque () {
-            destroy(_a, _inner_begin, _inner_end);
-            for (int i = 0; i < _bucket_end - _bucket_begin; ++i) {
-                _a.deallocate(_bucket_begin[i], DEFAULT_ARRAY_SIZE);
-            }
-            
-            _pa.deallocate(_bucket_begin, _bucket_end - _bucket_begin);
+            release();
+            fold_stats();
             assert(valid());}
 
         // ----------
@@ -697,25 +2526,30 @@ class my_deque {
          * deep copies rhs and assigns to this
          */
         my_deque& operator = (const my_deque& rhs) {
+            if (this == &rhs)
+                return *this;
+            typedef typename alloc_traits::propagate_on_container_copy_assignment pocca;
+            if (pocca::value && !(_a == rhs._a))
+                release();
+            adopt_allocators(rhs, pocca());
             clear();
-            _pa.deallocate(_bucket_begin, _bucket_end - _bucket_begin);
-            destroy(_a, _data_begin, _inner_end);
-            _a.deallocate(_data_begin, _inner_end - _data_begin);
-
-            size_type new_size = rhs.size();
-            size_type num_arrays = new_size / DEFAULT_ARRAY_SIZE + (new_size % DEFAULT_ARRAY_SIZE? 1 : 0);
-
-            _bucket_begin = _pa.allocate(num_arrays);
-            for(size_type i = 0; i < num_arrays; ++i){
-                _bucket_begin[i] = _a.allocate(DEFAULT_ARRAY_SIZE);
-            }
-
-            _inner_begin = _data_begin = _a.allocate(new_size);
-            _data_end = _data_begin + new_size;
-            _inner_end = _inner_begin + (rhs._inner_end - rhs._inner_begin);
-            _data_end = uninitialized_copy(_a, rhs._data_begin, rhs._data_end, _data_begin);
-
+            uninitialized_append(rhs.begin(), rhs.size());
+            assert(valid());
+            return *this;}
 
+        /**
+         * @param this
+         * @param deque rhs
+         * @return deque reference
+         * frees this, then takes over the blocks of rhs, and its allocator if
+         * that propagates; an unequal allocator that stays moves the elements
+         */
+        my_deque& operator = (my_deque&& rhs)
+                noexcept(alloc_traits::propagate_on_container_move_assignment::value ||
+                         alloc_traits::is_always_equal::value) {
+            if (this == &rhs)
+                return *this;
+            move_assign(rhs, typename alloc_traits::propagate_on_container_move_assignment());
             assert(valid());
             return *this;}
 
@@ -726,13 +2560,15 @@ class my_deque {
         /**
          * @param index
          * @return reference
-         * returns reference to object at index in deque
+         * returns reference to object at index in deque, unchecked unless
+         * DEQUE_DEBUG is on, when a bad index aborts
          */
         reference operator [] (size_type index) {
-            if(index > size() - 1)
-                throw std::out_of_range("Bad Index");
-            reference x = *(_data_begin+ index);
-            return x;}
+#if DEQUE_DEBUG
+            if (index >= size())
+                deque_debug_failure("my_deque::operator[] index out of range");
+#endif
+            return *element(index);}
 
         /**
          * @param index
@@ -742,6 +2578,62 @@ class my_deque {
         const_reference operator [] (size_type index) const {
             return const_cast<my_deque*>(this)->operator[](index);}
 
+        // ------------
+        // append_range
+        // ------------
+
+        /**
+         * @param b - iterator to the first value
+         * @param e - iterator one past the last value
+         * appends a copy of [b, e) to the back of deque
+         * forward iterators size the block map once
+         */
+        template <typename II>
+        void append_range (II b, II e) {
+            append_range(b, e, typename std::iterator_traits<II>::iterator_category());
+            assert(valid());}
+
+        /**
+         * @param r - range of values
+         * appends a copy of r to the back of deque
+         */
+        template <typename R>
+        void append_range (const R& r) {
+            append_range(std::begin(r), std::end(r));}
+
+        // ------
+        // assign
+        // ------
+
+        /**
+         * @param b - iterator to the first value
+         * @param e - iterator one past the last value
+         * replaces the contents of deque with a copy of [b, e)
+         */
+        template <typename II>
+        typename std::enable_if<!std::is_integral<II>::value>::type assign (II b, II e) {
+            clear();
+            append_range(b, e);
+            assert(valid());}
+
+        /**
+         * @param s - new size
+         * @param v - value to fill with
+         * replaces the contents of deque with s copies of v
+         */
+        void assign (size_type s, const_reference v) {
+            const value_type x = v;
+            clear();
+            uninitialized_append(s, x);
+            assert(valid());}
+
+        /**
+         * @param l - list of values
+         * replaces the contents of deque with a copy of l
+         */
+        void assign (std::initializer_list<value_type> l) {
+            assign(l.begin(), l.end());}
+
         // --
         // at
         // --
@@ -749,16 +2641,13 @@ class my_deque {
         /**
          * @param index
          * @return reference
-         * returns referece to object at index in deque
+         * returns reference to object at index in deque, in constant time
+         * @throws out_of_range when index is not below size()
          */
         reference at (size_type index) {
-            size_type i =0;
-            auto _at = begin();
-            while(i != index){
-                ++_at;
-                ++i;
-            }
-            return *_at;}
+            if (index >= size())
+                throw std::out_of_range("my_deque::at index out of range");
+            return *element(index);}
 
         /**
          * @param index
@@ -790,6 +2679,19 @@ class my_deque {
         const_reference back () const {
             return const_cast<my_deque*>(this)->back();}
 
+        // -------------
+        // back_capacity
+        // -------------
+
+        /**
+         * @param this
+         * @return number of push_back calls served by blocks already in the map
+         */
+        size_type back_capacity () const {
+            if (!_bucket_begin)
+                return 0;
+            return run_end() * DEFAULT_ARRAY_SIZE - 1 - (_offset + _size);}
+
         // -----
         // begin
         // -----
@@ -820,12 +2722,92 @@ class my_deque {
          * clears the deque 
          */
         void clear () {
-            _pa.deallocate(_bucket_begin, _bucket_end - _bucket_begin);
-            destroy(_a, _inner_begin, _inner_end);
-            _a.deallocate(_inner_begin, _inner_end - _inner_begin);
-            resize(0);
+            if (!_bucket_begin)
+                return;
+            destroy_range(_offset, _offset + _size);
+            pointer keep = _bucket_begin[_offset / DEFAULT_ARRAY_SIZE];
+            _bucket_begin[_offset / DEFAULT_ARRAY_SIZE] = 0;
+            for (size_type i = 0; i < map_size(); ++i)
+                release_block(i);
+            _offset = (map_size() / 2) * DEFAULT_ARRAY_SIZE;
+            _size   = 0;
+            _bucket_begin[_offset / DEFAULT_ARRAY_SIZE] = keep;
+            invalidate_iterators();
             assert(valid());}
 
+        // -------
+        // emplace
+        // -------
+
+        /**
+         * @param given_pos - position where the new object should go
+         * @param args - constructor arguments for the new object
+         * @return iterator - iterator to the new object
+         * only the elements between given_pos and the nearer end are moved
+         */
+        template <typename... Args>
+        iterator emplace (iterator given_pos, Args&&... args) {
+            const size_type i = given_pos - begin();
+            if (i == 0) {
+                emplace_front(std::forward<Args>(args)...);
+                return begin();}
+            if (i == size()) {
+                emplace_back(std::forward<Args>(args)...);
+                return end() - 1;}
+            value_type x(std::forward<Args>(args)...);
+            if (i < size() / 2) {
+                emplace_front(std::move(front()));
+                iterator b = begin();
+                tally(&deque_stats::moves, i);
+                std::move(b + 2, b + (i + 1), b + 1);}
+            else {
+                emplace_back(std::move(back()));
+                iterator e = end();
+                tally(&deque_stats::moves, size() - i);
+                std::move_backward(begin() + i, e - 2, e - 1);}
+            iterator p = begin() + i;
+            *p = std::move(x);
+            assert(valid());
+            return p;}
+
+        /**
+         * @param args - constructor arguments for the new object
+         * @return reference to the new last object
+         * constructs an object in place at the back of deque
+         * allocates at most one block, no element is moved
+         */
+        template <typename... Args>
+        reference emplace_back (Args&&... args) {
+            reserve_blocks_at_back(1);
+            pointer p = element(_size);
+            alloc_traits::construct(_a, p, std::forward<Args>(args)...);
+            ++_size;
+            tally(&deque_stats::constructions);
+            tally(&deque_stats::back_ops);
+            tally_size();
+            assert(valid());
+            return *p;}
+
+        /**
+         * @param args - constructor arguments for the new object
+         * @return reference to the new first object
+         * constructs an object in place at the front of deque
+         * allocates at most one block, no element is moved
+         */
+        template <typename... Args>
+        reference emplace_front (Args&&... args) {
+            reserve_map_at_front(1);
+            const size_type j = _offset - 1;
+            pointer p = block(j / DEFAULT_ARRAY_SIZE) + j % DEFAULT_ARRAY_SIZE;
+            alloc_traits::construct(_a, p, std::forward<Args>(args)...);
+            --_offset;
+            ++_size;
+            tally(&deque_stats::constructions);
+            tally(&deque_stats::front_ops);
+            tally_size();
+            assert(valid());
+            return *p;}
+
         // -----
         // empty
         // -----
@@ -867,34 +2849,43 @@ class my_deque {
          * @return iterator
          * removes the object at the current iterator and returns new iterator pointing
          *      to new objec at that position
+         * only the elements between given_pos and the nearer end are shifted
          */
         iterator erase (iterator given_pos) {
-            
-           auto b = begin(); 
-           auto e = end();
-           size_type size = distance(b,e) - 1;
-           size_type index_pos = distance(b , given_pos) ;
-            // cout << "This is size: " << size << endl;
-            // cout << "This is index_pos: " << index_pos <<endl;        
-           my_deque x(size,0);
-           size_type i = 0;
-           for (auto pos = x.begin(), end = x.end(); pos!=end;) {
-                if(i == index_pos){
-                    ++b;
-                }
-                else{
-
-                    *pos = *b;
-                    ++b;
-
-                    ++pos;
-                }  
-                ++i;
+            assert(!empty());
+            const size_type i = given_pos - begin();
+            if (i < size() / 2) {
+                tally(&deque_stats::moves, i);
+                std::move_backward(begin(), given_pos, given_pos + 1);
+                pop_front();}
+            else {
+                tally(&deque_stats::moves, size() - i - 1);
+                std::move(given_pos + 1, end(), given_pos);
+                pop_back();}
+            assert(valid());
+            return begin() + i;}
 
-            }
-            swap(x);
+        /**
+         * @param b - iterator to the first object to remove
+         * @param e - iterator one past the last object to remove
+         * @return iterator - iterator to the object that followed the range
+         * removes [b, e), shifting only the elements on the shorter side
+         */
+        iterator erase (iterator b, iterator e) {
+            const size_type i = b - begin();
+            const size_type n = e - b;
+            if (!n)
+                return b;
+            if (i < size() - i - n) {
+                tally(&deque_stats::moves, i);
+                std::move_backward(begin(), b, e);
+                erase_at_front(n);}
+            else {
+                tally(&deque_stats::moves, size() - i - n);
+                std::move(e, end(), b);
+                erase_at_back(n);}
             assert(valid());
-            return iterator(&x, index_pos);}
+            return begin() + i;}
 
         // -----
         // front
@@ -917,6 +2908,29 @@ class my_deque {
         const_reference front () const {
             return const_cast<my_deque*>(this)->front();}
 
+        // --------------
+        // front_capacity
+        // --------------
+
+        /**
+         * @param this
+         * @return number of push_front calls served by blocks already in the map
+         */
+        size_type front_capacity () const {
+            if (!_bucket_begin)
+                return 0;
+            return _offset - run_begin() * DEFAULT_ARRAY_SIZE;}
+
+        // -------------
+        // get_allocator
+        // -------------
+
+        /**
+         * @return a copy of the allocator the elements come from
+         */
+        allocator_type get_allocator () const {
+            return _a;}
+
         // ------
         // insert
         // ------
@@ -925,33 +2939,122 @@ class my_deque {
          * @param iterator - position where insert should occur
          * @param v - value to insert at position
          * @return iterator - returns new iterator to item inserted at current position
+         * only the elements between given_pos and the nearer end are shifted
          */
         iterator insert (iterator given_pos, const_reference v) {
-           
-           auto b = begin(); 
-           auto e = end();
-           size_type size = distance(b,e) + 1;
-           size_type index_pos = distance(b , given_pos) ;
-
-           my_deque x(size,0);
-           size_type i = 0;
-           for (auto pos = x.begin(), end = x.end(); pos!=end; ++pos) {
-                if(i == index_pos){
-                    *pos = v;
-                }
-                else{
-                    *pos = *b;
-                    ++b;
-                }                  
-                ++i;    
-            }
+            return emplace(given_pos, v);}
 
+        /**
+         * @param iterator - position where insert should occur
+         * @param v - value to move into position
+         * @return iterator - returns new iterator to item inserted at current position
+         */
+        iterator insert (iterator given_pos, value_type&& v) {
+            return emplace(given_pos, std::move(v));}
 
-           
-            swap(x);
+        /**
+         * @param given_pos - position where insert should occur
+         * @param n - number of copies to insert
+         * @param v - value to insert
+         * @return iterator - iterator to the first inserted object
+         * constructs the copies at the nearer end and rotates them into place
+         */
+        iterator insert (iterator given_pos, size_type n, const_reference v) {
+            const size_type i = given_pos - begin();
+            const size_type s = size();
+            if (i < s - i) {
+                uninitialized_prepend(n, v);
+                iterator x = begin();
+                tally(&deque_stats::moves, n + i);
+                std::rotate(x, x + n, x + (n + i));}
+            else {
+                uninitialized_append(n, v);
+                iterator x = begin();
+                tally(&deque_stats::moves, size() - i);
+                std::rotate(x + i, x + s, end());}
+            assert(valid());
+            return begin() + i;}
 
+        /**
+         * @param given_pos - position where insert should occur
+         * @param b - iterator to the first value
+         * @param e - iterator one past the last value
+         * @return iterator - iterator to the first inserted object
+         * forward iterators size the block map once
+         */
+        template <typename II>
+        typename std::enable_if<!std::is_integral<II>::value, iterator>::type
+        insert (iterator given_pos, II b, II e) {
+            const size_type i = given_pos - begin();
+            insert_range(i, b, e, typename std::iterator_traits<II>::iterator_category());
             assert(valid());
-            return iterator(&x, index_pos);}
+            return begin() + i;}
+
+        /**
+         * @param given_pos - position where insert should occur
+         * @param l - list of values
+         * @return iterator - iterator to the first inserted object
+         */
+        iterator insert (iterator given_pos, std::initializer_list<value_type> l) {
+            return insert(given_pos, l.begin(), l.end());}
+
+        // ----------------
+        // max_spare_blocks
+        // ----------------
+
+        /**
+         * @param this
+         * @return number of emptied blocks this deque keeps for reuse
+         */
+        size_type max_spare_blocks () const {
+            return _spare_limit;}
+
+        /**
+         * @param n - number of emptied blocks to keep for reuse
+         * blocks emptied by pops and erases are kept, up to n of them, and
+         * handed to the next push at either end instead of being freed
+         */
+        void max_spare_blocks (size_type n) {
+            _spare_limit = n;
+            trim_spares(n);}
+
+        // ------------
+        // memory_usage
+        // ------------
+
+        /**
+         * @return the bytes of the elements, of the map, of the block storage
+         * reserved at each end and of the spare blocks, with the number of
+         * blocks held and of those partly filled
+         * walks the block map once and touches no element
+         */
+        deque_memory memory_usage () const {
+            const size_type block_bytes = DEFAULT_ARRAY_SIZE * sizeof(T);
+            deque_memory m;
+            m.spare_bytes = _spare_count * block_bytes;
+            m.blocks      = _spare_count;
+            if (!_bucket_begin)
+                return m;
+            const size_type first = _offset / DEFAULT_ARRAY_SIZE;
+            const size_type last  = (_offset + _size) / DEFAULT_ARRAY_SIZE;
+            for (size_type i = 0; i != map_size(); ++i)
+                if (_bucket_begin[i]) {
+                    ++m.blocks;
+                    if (i < first)
+                        m.front_unused_bytes += block_bytes;
+                    else if (i > last)
+                        m.back_unused_bytes += block_bytes;}
+            m.element_bytes       = _size * sizeof(T);
+            m.map_bytes           = map_size() * sizeof(pointer);
+            m.front_unused_bytes += (_offset % DEFAULT_ARRAY_SIZE) * sizeof(T);
+            m.back_unused_bytes  += (DEFAULT_ARRAY_SIZE - (_offset + _size) % DEFAULT_ARRAY_SIZE) * sizeof(T);
+            if (_size) {
+                const size_type back = (_offset + _size - 1) / DEFAULT_ARRAY_SIZE;
+                if (back == first)
+                    m.partial_blocks = (_size != DEFAULT_ARRAY_SIZE);
+                else
+                    m.partial_blocks = (_offset % DEFAULT_ARRAY_SIZE != 0) + ((_offset + _size) % DEFAULT_ARRAY_SIZE != 0);}
+            return m;}
 
         // ---
         // pop
@@ -962,7 +3065,14 @@ class my_deque {
          * removes the last element in deque
          */
         void pop_back () {
-            _data_end = destroy(_a, _data_end - 1, _data_end);
+            assert(!empty());
+            const size_type j = _offset + _size;
+            pointer p = element(_size - 1);
+            destroy(_a, p, p + 1);
+            --_size;
+            tally(&deque_stats::back_ops);
+            if (!(j % DEFAULT_ARRAY_SIZE))
+                release_block(j / DEFAULT_ARRAY_SIZE);
             assert(valid());}
 
         /**
@@ -970,129 +3080,148 @@ class my_deque {
          * removes the first element in deque
          */
         void pop_front () {
-            _data_begin = destroy(_a, _data_begin, _data_begin + 1);
-            ++_data_begin;
+            assert(!empty());
+            const size_type j = _offset;
+            pointer p = element(0);
+            destroy(_a, p, p + 1);
+            ++_offset;
+            --_size;
+            tally(&deque_stats::front_ops);
+            if (!(_offset % DEFAULT_ARRAY_SIZE))
+                release_block(j / DEFAULT_ARRAY_SIZE);
             assert(valid());}
 
         // ----
         // push
         // ----
 
-
-
         /**
          * @param v - value to add to deque
          * adds v to the back of deque
+         * allocates at most one block, no element is moved
          */
         void push_back (const_reference v) {
-            using namespace std;
-            if(_data_end == _inner_end){
-                if(_data_end == 0){
-                    _bucket_begin = _pa.allocate(DEFAULT_BUCKET_SIZE);
-                    for(unsigned int i = 0; i < DEFAULT_BUCKET_SIZE; ++i)
-                        _bucket_begin[i] = _a.allocate(DEFAULT_ARRAY_SIZE);
-
-                    _bucket_end = _bucket_begin + DEFAULT_BUCKET_SIZE;
-                    _inner_begin = _a.allocate( DEFAULT_BUCKET_SIZE * DEFAULT_ARRAY_SIZE);
-                    _data_end = _data_begin = _inner_begin;
-                    _inner_end = _inner_begin + (DEFAULT_BUCKET_SIZE * DEFAULT_ARRAY_SIZE);
-                    _data_end = uninitialized_fill(_a, _data_begin, _data_begin +1, v);
-                }
-                else{
-                    size_type old_size = size();
-                    size_type new_size = size() * 2;
-                    size_type num_arrays = new_size / DEFAULT_ARRAY_SIZE + (new_size % DEFAULT_ARRAY_SIZE? 1 : 0);
-
-                    p_p temp_fr(0);
-                    p_p temp_ba(0);
-
-                    temp_fr = _pa.allocate(num_arrays);
-
-                    for(size_type i = 0; i < num_arrays; ++i){
-                        temp_fr[i] = _a.allocate(DEFAULT_ARRAY_SIZE);
-                    }
-
-                    temp_ba = temp_fr + num_arrays;
-
-                    for(int i = 0; i < _bucket_end - _bucket_begin; ++i){
-                        temp_fr[i] = _bucket_begin[i];
-                    }
-                    
-                    destroy(_a, _inner_begin, _inner_end);
-                    _pa.deallocate(_bucket_begin, _bucket_end - _bucket_begin);
-                    _bucket_begin = temp_fr;
-                    _bucket_end = temp_ba;
-                    pointer old_front = _inner_begin;
-                    _inner_begin = _a.allocate(num_arrays * new_size);
-
-                    _data_end = uninitialized_copy(_a, _data_begin, _data_end, _inner_begin);
-                    _a.deallocate(old_front, _inner_end - old_front);
-                    _data_begin = _inner_begin;
-                    _inner_end = _inner_begin + (new_size * num_arrays);
-                    push_back(v);
-                } 
-
-            }
-            else if(_data_end != _inner_end){
-                _data_end = uninitialized_fill(_a, _data_end, _data_end + 1, v);
-            }
-            assert(valid());}
+            emplace_back(v);}
+
+        /**
+         * @param v - value to move to deque
+         * moves v to the back of deque
+         */
+        void push_back (value_type&& v) {
+            emplace_back(std::move(v));}
 
         /**
          * @param v - value to add to deque
          * adds v to front of deque
+         * allocates at most one block, no element is moved
          */
         void push_front (const_reference v) {
-            if(_data_begin == _inner_begin){
-                if(_data_begin == 0){
-                    _bucket_begin = _pa.allocate(DEFAULT_BUCKET_SIZE);
-                    for(unsigned int i = 0; i < DEFAULT_BUCKET_SIZE; ++i)
-                        _bucket_begin[i] = _a.allocate(DEFAULT_ARRAY_SIZE);
-
-                    _bucket_end = _bucket_begin + DEFAULT_BUCKET_SIZE;
-                    _inner_begin = _a.allocate(DEFAULT_BUCKET_SIZE * DEFAULT_ARRAY_SIZE);
-                    _inner_end = _inner_begin + (DEFAULT_BUCKET_SIZE * DEFAULT_ARRAY_SIZE);
-                    _data_begin = _inner_begin + DEFAULT_ARRAY_SIZE;
-                    _data_end = uninitialized_fill(_a, _data_begin, _data_begin +1, v);
-
-                }else{
-                    size_type old_size = size();
-                    size_type new_size = size() * 2;
-                    size_type num_arrays = new_size / DEFAULT_ARRAY_SIZE + (new_size % DEFAULT_ARRAY_SIZE? 1 : 0);
-
-                    p_p temp_fr(0);
-                    p_p temp_ba(0);
-
-                    temp_fr = _pa.allocate(num_arrays);
-
-                    for(size_type i = 0; i < num_arrays; ++i){
-                        temp_fr[i] = _a.allocate(DEFAULT_ARRAY_SIZE);
-                    }
-
-                    temp_ba = temp_fr + num_arrays;
-
-                    for(int i = 1; i < _bucket_end - _bucket_begin; ++i){
-                        temp_fr[i] = _bucket_begin[i];
-                    }
-
-                    destroy(_a, _inner_begin, _inner_end);
-                    _pa.deallocate(_bucket_begin, _bucket_end - _bucket_begin);
-                    _bucket_begin = temp_fr;
-                    _bucket_end = temp_ba;
-                    pointer old_front = _inner_begin;
-                    _inner_begin = _a.allocate(num_arrays * new_size);
-
-                    _data_end = uninitialized_copy(_a, _data_begin, _data_end, _inner_begin + DEFAULT_ARRAY_SIZE);
-                    _a.deallocate(old_front, _inner_end - old_front);
-                    _data_begin = _inner_begin + DEFAULT_ARRAY_SIZE;
-                    _inner_end = _inner_begin + (new_size * num_arrays);
-                    push_front(v);
-                }
-            }
-            else if(_data_begin != _inner_begin){
-                _data_begin = uninitialized_fill(_a, _data_begin -1, _data_begin, v);
-                --_data_begin;
-            }
+            emplace_front(v);}
+
+        /**
+         * @param v - value to move to deque
+         * moves v to front of deque
+         */
+        void push_front (value_type&& v) {
+            emplace_front(std::move(v));}
+
+        // ---------
+        // read_from
+        // ---------
+
+        /**
+         * @param in - stream positioned at what write_to wrote
+         * @return in
+         * appends the elements to the back, reading straight into the blocks
+         * one block at a time, so the deque grows as the data arrives
+         * a header for another element size sets failbit and reads nothing,
+         * a stream that ends early leaves the whole elements read so far
+         */
+        std::istream& read_from (std::istream& in) {
+            static_assert(std::is_trivially_copyable<T>::value, "read_from needs a trivially copyable T");
+            deque_stream_header h;
+            if (!in.read(reinterpret_cast<char*>(&h), sizeof(h)))
+                return in;
+            if (!stream_header_fits(h)) {
+                in.setstate(std::ios_base::failbit);
+                return in;}
+            size_type n = h.count;
+            while (n) {
+                const size_type k = std::min(n, DEFAULT_ARRAY_SIZE - (_offset + _size) % DEFAULT_ARRAY_SIZE);
+                reserve_blocks_at_back(k);
+                in.read(reinterpret_cast<char*>(&*element(_size)), k * sizeof(T));
+                _size += in.gcount() / sizeof(T);
+                n     -= k;
+                if (!in)
+                    break;}
+            assert(valid());
+            return in;}
+
+#if DEQUE_GATHER_IO
+        /**
+         * @param fd - file descriptor positioned at what write_to wrote
+         * appends the elements to the back with readv, straight into the
+         * blocks, which are added as the data arrives
+         * @throws system_error when a read fails, runtime_error when the
+         * header is for another element size or the data ends early; the
+         * whole elements read so far stay
+         */
+        void read_from (int fd) {
+            static_assert(std::is_trivially_copyable<T>::value, "read_from needs a trivially copyable T");
+            deque_stream_header h;
+            std::size_t done = 0;
+            while (done != sizeof(h)) {
+                const ssize_t r = ::read(fd, reinterpret_cast<char*>(&h) + done, sizeof(h) - done);
+                if ((r < 0) && (errno == EINTR))
+                    continue;
+                if (r < 0)
+                    throw std::system_error(errno, std::system_category(), "my_deque::read_from");
+                if (r == 0)
+                    throw std::runtime_error("my_deque::read_from stream ended early");
+                done += r;}
+            if (!stream_header_fits(h))
+                throw std::runtime_error("my_deque::read_from stream holds another element type");
+            const size_type start = _size;
+            const std::size_t total = h.count * sizeof(T);
+            iovec v[IO_VECTORS];
+            done = 0;
+            while (done != total) {
+                const size_type left = h.count - done / sizeof(T);
+                reserve_blocks_at_back(std::min<size_type>(left, IO_VECTORS * DEFAULT_ARRAY_SIZE));
+                const ssize_t r = ::readv(fd, v, gather(_size, done % sizeof(T), left, v, IO_VECTORS));
+                if ((r < 0) && (errno == EINTR))
+                    continue;
+                if (r < 0)
+                    throw std::system_error(errno, std::system_category(), "my_deque::read_from");
+                if (r == 0)
+                    throw std::runtime_error("my_deque::read_from stream ended early");
+                done += r;
+                _size = start + done / sizeof(T);}
+            assert(valid());}
+#endif
+
+        // -------
+        // reserve
+        // -------
+
+        /**
+         * @param n - number of elements
+         * allocates enough blocks that the next n push_back calls will not
+         * allocate
+         */
+        void reserve_back (size_type n) {
+            if (back_capacity() < n)
+                reserve_blocks_at_back(n);
+            assert(valid());}
+
+        /**
+         * @param n - number of elements
+         * allocates enough blocks that the next n push_front calls will not
+         * allocate
+         */
+        void reserve_front (size_type n) {
+            if (front_capacity() < n)
+                reserve_blocks_at_front(n);
             assert(valid());}
 
         // ------
@@ -1103,23 +3232,55 @@ class my_deque {
          * @param s - new size
          * @param v - value to fill with - defaulted
          * resizes the current deque to size s and fills with v if growing
+         * the block map is sized once, shrinking releases the emptied blocks
          */
         void resize (size_type s, const_reference v = value_type()) {
-            if(s < size())
-            {
-                pop_back();
-                resize(s, v);
-            }
-            else if(s > size())
-            {
-                push_back(v);
-                resize(s, v);
-            }
-
-            else
-                return;
+            if (s < size())
+                erase_at_back(size() - s);
+            else if (s > size())
+                uninitialized_append(s - size(), v);
             assert(valid());}
 
+        // -----------
+        // reset_stats
+        // -----------
+
+        /**
+         * zeroes the counters stats() reads, folding them into
+         * global_deque_stats() first with DEQUE_STATS 2
+         */
+#if DEQUE_STATS
+        void reset_stats () {
+            fold_stats();
+            _stats = deque_stats();}
+#else
+        void reset_stats () {}
+#endif
+
+        // --------
+        // segments
+        // --------
+
+        /**
+         * @return the elements as contiguous segments, one per block
+         */
+        segment_view<iterator> segments () {
+            return segments(begin(), end());}
+
+        segment_view<const_iterator> segments () const {
+            return segments(begin(), end());}
+
+        /**
+         * @param b - iterator to the first element
+         * @param e - iterator one past the last element
+         * @return [b, e) as contiguous segments, one per block
+         */
+        static segment_view<iterator> segments (iterator b, iterator e) {
+            return segment_view<iterator>(b, e);}
+
+        static segment_view<const_iterator> segments (const_iterator b, const_iterator e) {
+            return segment_view<const_iterator>(b, e);}
+
         // ----
         // size
         // ----
@@ -1128,8 +3289,98 @@ class my_deque {
          * returns the size of the deque
          */
         size_type size () const {
-            return _data_end - _data_begin;
-        }
+            return _size;}
+
+        // -------------
+        // shrink_to_fit
+        // -------------
+
+        /**
+         * @param this
+         * returns every spare block to the allocator, past the thread cache,
+         * and shrinks the block map to the slots the elements occupy, no
+         * element is moved
+         */
+        void shrink_to_fit () {
+            trim_spares(0, false);
+            if (!_bucket_begin)
+                return;
+            if (empty()) {
+                release(false);
+                return;}
+            const size_type first = _offset / DEFAULT_ARRAY_SIZE;
+            const size_type last  = (_offset + _size) / DEFAULT_ARRAY_SIZE;
+            for (size_type i = 0; i < first; ++i)
+                if (_bucket_begin[i])
+                    deallocate_block(_bucket_begin[i], false);
+            for (size_type i = last + 1; i < map_size(); ++i)
+                if (_bucket_begin[i])
+                    deallocate_block(_bucket_begin[i], false);
+            const size_type s = last - first + 1;
+            if (s != map_size()) {
+                p_p new_map = p_a_traits::allocate(_pa, s);
+                std::copy(_bucket_begin + first, _bucket_begin + last + 1, new_map);
+                p_a_traits::deallocate(_pa, _bucket_begin, map_size());
+                tally(&deque_stats::allocations);
+                tally(&deque_stats::deallocations);
+                _bucket_begin = new_map;
+                _bucket_end   = new_map + s;
+                _offset      -= first * DEFAULT_ARRAY_SIZE;}
+            invalidate_iterators();
+            assert(valid());}
+
+        // ------------
+        // spare_blocks
+        // ------------
+
+        /**
+         * @param this
+         * @return number of emptied blocks currently kept for reuse
+         */
+        size_type spare_blocks () const {
+            return _spare_count;}
+
+        // -----
+        // stats
+        // -----
+
+        /**
+         * @return a snapshot of the counters since construction or the last
+         * reset_stats(), with bytes_reserved measured now; all zeros when
+         * DEQUE_STATS is 0
+         */
+#if DEQUE_STATS
+        deque_stats stats () const {
+            deque_stats x = _stats;
+            size_type blocks = _spare_count;
+            for (size_type i = 0; i != map_size(); ++i)
+                blocks += (_bucket_begin[i] != pointer());
+            x.bytes_reserved = blocks * DEFAULT_ARRAY_SIZE * sizeof(T) + map_size() * sizeof(pointer);
+            return x;}
+#else
+        deque_stats stats () const {
+            return deque_stats();}
+#endif
+
+        // -------------------
+        // thread_cache_blocks
+        // -------------------
+
+        /**
+         * @return number of blocks the calling thread may cache for every
+         * deque of this type, 0 when the cache is off
+         */
+        static size_type thread_cache_blocks () {
+            return cache_limit(can_cache());}
+
+        /**
+         * @param n - number of blocks the calling thread may cache
+         * blocks a deque cannot keep go to the thread cache, and any deque of
+         * this type on the thread takes from it before calling the allocator
+         * only stateless allocators use the cache, 0 turns it off
+         */
+        static void thread_cache_blocks (size_type n) {
+            limit_cache(n, can_cache());}
 
         // ----
         // swap
@@ -1138,22 +3389,94 @@ class my_deque {
         /**
          * @param this - deque
          * @param that - deque
-         * if allocators are equivalent - swaps all elements between this and that
-         * else creates a copy of this and swaps deques between copy, this and that
+         * swaps the block maps, blocks and spares of this and that in constant
+         * time, no element is touched
+         * the allocators swap too when they propagate on swap, otherwise they
+         * must be equal, as for the standard containers
          */
-        void swap (my_deque& that) {
-             destroy(_a, _inner_begin, _inner_end);
-            _a.deallocate(_inner_begin, _inner_end - _inner_begin);
+        void swap (my_deque& that) noexcept {
+            swap_allocators(that, typename alloc_traits::propagate_on_container_swap());
+            std::swap(_bucket_begin, that._bucket_begin);
+            std::swap(_bucket_end,   that._bucket_end);
+            std::swap(_offset,       that._offset);
+            std::swap(_size,         that._size);
+            std::swap(_spare,        that._spare);
+            std::swap(_spare_count,  that._spare_count);
+            std::swap(_spare_limit,  that._spare_limit);
+            assert(valid());}
 
-            if (_a == that._a) {
-                std::swap(_inner_begin, that._inner_begin);
-                std::swap(_data_begin, that._data_begin);
-                std::swap(_data_end, that._data_end);
-                std::swap(_inner_end, that._inner_end);}
-            else {
-                my_deque x(*this);
-                *this = that;
-                that = x;}
-            assert(valid());}};
+        // --------
+        // write_to
+        // --------
+
+#if DEQUE_GATHER_IO
+        /**
+         * @param fd - file descriptor to write to
+         * writes the header and the blocks with writev, up to IOV_MAX vectors
+         * a call, straight from the blocks with no buffer in between
+         * @throws system_error when a write fails
+         */
+        void write_to (int fd) const {
+            static_assert(std::is_trivially_copyable<T>::value, "write_to needs a trivially copyable T");
+            const deque_stream_header h = stream_header();
+            const std::size_t total = sizeof(h) + _size * sizeof(T);
+            std::size_t done = 0;
+            iovec v[IO_VECTORS];
+            while (done != total) {
+                int c = 0;
+                std::size_t e = 0;      // element bytes done
+                if (done < sizeof(h)) {
+                    v[0].iov_base = const_cast<char*>(reinterpret_cast<const char*>(&h)) + done;
+                    v[0].iov_len  = sizeof(h) - done;
+                    c = 1;}
+                else
+                    e = done - sizeof(h);
+                c += gather(e / sizeof(T), e % sizeof(T), _size - e / sizeof(T), v + c, IO_VECTORS - c);
+                const ssize_t w = ::writev(fd, v, c);
+                if ((w < 0) && (errno == EINTR))
+                    continue;
+                if (w < 0)
+                    throw std::system_error(errno, std::system_category(), "my_deque::write_to");
+                done += w;}}
+#endif
+
+        /**
+         * @param out - stream to write to
+         * @return out
+         * writes a deque_stream_header and then each block with one write,
+         * for reading back with read_from
+         */
+        std::ostream& write_to (std::ostream& out) const {
+            static_assert(std::is_trivially_copyable<T>::value, "write_to needs a trivially copyable T");
+            const deque_stream_header h = stream_header();
+            out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+            typedef typename segment_view<const_iterator>::iterator segment_iterator;
+            const segment_view<const_iterator> w = segments();
+            for (segment_iterator s = w.begin(); out && (s != w.end()); ++s)
+                out.write(reinterpret_cast<const char*>(&*s->first), s->count * sizeof(T));
+            return out;}};
+
+template <std::size_t Bytes>
+const std::size_t page_growth<Bytes>::page_slots;
+
+template <typename T, typename A, typename B, typename G>
+const typename my_deque<T, A, B, G>::size_type my_deque<T, A, B, G>::DEFAULT_ARRAY_SIZE;
+
+template <typename T, typename A, typename B, typename G>
+const typename my_deque<T, A, B, G>::size_type my_deque<T, A, B, G>::DEFAULT_BUCKET_SIZE;
+
+template <typename T, typename A, typename B, typename G>
+const typename my_deque<T, A, B, G>::size_type my_deque<T, A, B, G>::DEFAULT_SPARE_BLOCKS;
+
+template <typename T, typename A, typename B, typename G>
+const bool my_deque<T, A, B, G>::CAN_RECYCLE;
+
+template <typename T, typename A, typename B, typename G>
+const bool my_deque<T, A, B, G>::CAN_CACHE;
+
+#if DEQUE_GATHER_IO
+template <typename T, typename A, typename B, typename G>
+const int my_deque<T, A, B, G>::IO_VECTORS;
+#endif
 
 #endif // Deque_h
@@ -0,0 +1,302 @@
+// -----------------------------
+// projects/deque/DequeBench.c++
+// -----------------------------
+
+// --------
+// includes
+// --------
+
+#include <algorithm>   // equal, max, min
+#include <chrono>      // steady_clock
+#include <cstdio>      // fflush, printf
+#include <cstdlib>     // atof
+#include <deque>       // deque
+#include <type_traits> // false_type, true_type
+#include <vector>      // vector
+
+#include "Deque.h"
+
+// -------
+// payload
+// -------
+
+/**
+ * a 64 byte element, a cache line on most machines
+ */
+struct payload {
+    long v[8];
+
+    payload () {
+        for (int i = 0; i != 8; ++i)
+            v[i] = 0;}
+
+    payload (long x) {
+        for (int i = 0; i != 8; ++i)
+            v[i] = x + i;}
+
+    friend bool operator == (const payload& lhs, const payload& rhs) {
+        return std::equal(lhs.v, lhs.v + 8, rhs.v);}};
+
+/**
+ * @return the part of an element the benchmarks fold into the sink
+ */
+inline long key (int x) {
+    return x;}
+
+inline long key (double x) {
+    return static_cast<long>(x);}
+
+inline long key (const payload& x) {
+    return x.v[0];}
+
+// -----
+// names
+// -----
+
+template <typename T> struct type_name;
+template <> struct type_name<int>     {static const char* get () {return "int";}};
+template <> struct type_name<double>  {static const char* get () {return "double";}};
+template <> struct type_name<payload> {static const char* get () {return "payload64";}};
+
+template <typename C> struct container_name;
+template <typename T> struct container_name<std::deque<T> >  {static const char* get () {return "std::deque";}};
+template <typename T> struct container_name<std::vector<T> > {static const char* get () {return "std::vector";}};
+template <typename T> struct container_name<my_deque<T> >    {static const char* get () {return "my_deque";}};
+
+// ----------
+// slow_front
+// ----------
+
+/**
+ * containers whose front operations move every element, so the front
+ * benchmarks stop at a smaller size for them
+ */
+template <typename C> struct slow_front                  : std::false_type {};
+template <typename T> struct slow_front<std::vector<T> > : std::true_type  {};
+
+template <typename C>
+void push_front (C& x, const typename C::value_type& v) {
+    x.push_front(v);}
+
+template <typename T>
+void push_front (std::vector<T>& x, const T& v) {
+    x.insert(x.begin(), v);}
+
+template <typename C>
+void pop_front (C& x) {
+    x.pop_front();}
+
+template <typename T>
+void pop_front (std::vector<T>& x) {
+    x.erase(x.begin());}
+
+// --------
+// reporter
+// --------
+
+/**
+ * prints the results as one JSON document, a list of records with the
+ * container, the element type, the operation, the size and the
+ * nanoseconds per operation
+ */
+class reporter {
+    private:
+        bool _first;
+
+    public:
+        reporter () :
+                _first(true) {
+            std::printf("{\n  \"benchmarks\": [");}
+
+        ~reporter () {
+            std::printf("\n  ]\n}\n");}
+
+        void add (const char* container, const char* type, const char* op, std::size_t n, double ns) {
+            std::printf("%s\n    {\"container\": \"%s\", \"type\": \"%s\", \"op\": \"%s\", \"n\": %zu, \"ns_per_op\": %.3f}",
+                        _first ? "" : ",", container, type, op, n, ns);
+            std::fflush(stdout);
+            _first = false;}};
+
+// -----
+// timer
+// -----
+
+typedef std::chrono::steady_clock clock_type;
+
+inline double elapsed_ns (clock_type::time_point b) {
+    return std::chrono::duration<double, std::nano>(clock_type::now() - b).count();}
+
+/**
+ * keeps the optimizer from throwing the benchmarked work away
+ */
+volatile long sink;
+
+/**
+ * @param s - state of a linear congruential generator, advanced
+ * @param n - bound
+ * @return a pseudo random index below n
+ */
+inline std::size_t next_index (unsigned long long& s, std::size_t n) {
+    s = s * 6364136223846793005ULL + 1442695040888963407ULL;
+    return static_cast<std::size_t>(s >> 33) % n;}
+
+// -----
+// bench
+// -----
+
+const std::size_t ELEMENT_OPS  = 1 << 22;   // rough work per measurement, small sizes repeat
+const std::size_t FRONT_LIMIT  = 10000;     // largest size for the front benchmarks of slow_front containers
+const std::size_t MIDDLE_OPS   = 64;        // inserts, then as many erases
+const std::size_t MIDDLE_LIMIT = 10000000;  // largest size for the middle benchmark
+
+/**
+ * @param r - where the results go
+ * @param n - number of elements
+ * runs every benchmark for container C at size n
+ */
+template <typename C>
+void bench (reporter& r, std::size_t n) {
+    typedef typename C::value_type T;
+    const char* c = container_name<C>::get();
+    const char* t = type_name<T>::get();
+    const std::size_t reps = std::max<std::size_t>(1, ELEMENT_OPS / n);
+    const std::size_t front_reps = slow_front<C>::value ? std::max<std::size_t>(1, ELEMENT_OPS / (n * n)) : reps;
+    clock_type::time_point b;
+
+    b = clock_type::now();
+    for (std::size_t k = 0; k != reps; ++k) {
+        C x;
+        for (std::size_t i = 0; i != n; ++i)
+            x.push_back(T(long(i)));
+        sink = sink + key(x.back());}
+    r.add(c, t, "push_back", n, elapsed_ns(b) / (n * reps));
+
+    if (!slow_front<C>::value || (n <= FRONT_LIMIT)) {
+        b = clock_type::now();
+        for (std::size_t k = 0; k != front_reps; ++k) {
+            C x;
+            for (std::size_t i = 0; i != n; ++i)
+                push_front(x, T(long(i)));
+            sink = sink + key(x.front());}
+        r.add(c, t, "push_front", n, elapsed_ns(b) / (n * front_reps));}
+
+    C x;
+    for (std::size_t i = 0; i != n; ++i)
+        x.push_back(T(long(i)));
+
+    if (!slow_front<C>::value || (n <= FRONT_LIMIT)) {
+        C y(x);
+        b = clock_type::now();
+        for (std::size_t k = 0; k != front_reps; ++k)
+            for (std::size_t i = 0; i != n; ++i) {
+                y.push_back(T(long(i)));
+                pop_front(y);}
+        sink = sink + key(y.front());
+        r.add(c, t, "fifo_churn", n, elapsed_ns(b) / (n * front_reps));}
+
+    {
+    unsigned long long s = 1;
+    long sum = 0;
+    b = clock_type::now();
+    for (std::size_t k = 0; k != reps; ++k)
+        for (std::size_t i = 0; i != n; ++i)
+            sum += key(x[next_index(s, n)]);
+    sink = sink + sum;
+    r.add(c, t, "random_access", n, elapsed_ns(b) / (n * reps));
+    }
+
+    {
+    unsigned long long s = 1;
+    long sum = 0;
+    b = clock_type::now();
+    for (std::size_t k = 0; k != reps; ++k)
+        for (std::size_t i = 0; i != n; ++i)
+            sum += key(x.at(next_index(s, n)));
+    sink = sink + sum;
+    r.add(c, t, "at", n, elapsed_ns(b) / (n * reps));
+    }
+
+    if (n <= MIDDLE_LIMIT) {
+        C y(x);
+        b = clock_type::now();
+        for (std::size_t i = 0; i != MIDDLE_OPS; ++i)
+            y.insert(y.begin() + y.size() / 2, T(long(i)));
+        for (std::size_t i = 0; i != MIDDLE_OPS; ++i)
+            y.erase(y.begin() + y.size() / 2);
+        sink = sink + key(y.back());
+        r.add(c, t, "middle_insert_erase", n, elapsed_ns(b) / (2 * MIDDLE_OPS));}
+
+    {
+    long sum = 0;
+    b = clock_type::now();
+    for (std::size_t k = 0; k != reps; ++k)
+        for (typename C::const_iterator p = x.begin(); p != x.end(); ++p)
+            sum += key(*p);
+    sink = sink + sum;
+    r.add(c, t, "iterate", n, elapsed_ns(b) / (n * reps));
+    }
+
+    {
+    b = clock_type::now();
+    for (std::size_t k = 0; k != reps; ++k) {
+        C y(x);
+        sink = sink + key(y.back());}
+    r.add(c, t, "copy", n, elapsed_ns(b) / (n * reps));
+    }
+
+    {
+    const C y(x);
+    b = clock_type::now();
+    for (std::size_t k = 0; k != reps; ++k)
+        sink = sink + (x == y);
+    r.add(c, t, "compare", n, elapsed_ns(b) / (n * reps));
+    }}
+
+// --------
+// my_types
+// --------
+
+template <typename... Cs>
+struct container_types {};
+
+typedef container_types<
+            std::deque<int>,
+            std::vector<int>,
+            my_deque<int>,
+            std::deque<double>,
+            std::vector<double>,
+            my_deque<double>,
+            std::deque<payload>,
+            std::vector<payload>,
+            my_deque<payload> >
+        my_types;
+
+inline void bench_all (container_types<>, reporter&, std::size_t, std::size_t) {}
+
+/**
+ * @param r - where the results go
+ * @param max_n - largest size
+ * @param budget - bytes two copies of a container may take
+ * runs each container in the list over sizes 10, 100, ... up to max_n
+ */
+template <typename C, typename... Cs>
+void bench_all (container_types<C, Cs...>, reporter& r, std::size_t max_n, std::size_t budget) {
+    for (std::size_t n = 10; (n <= max_n) && (2 * n * sizeof(typename C::value_type) <= budget); n *= 10)
+        bench<C>(r, n);
+    bench_all(container_types<Cs...>(), r, max_n, budget);}
+
+// ----
+// main
+// ----
+
+/**
+ * usage: DequeBench [max_n [budget_mb]]
+ * prints JSON on standard output, sizes whose two copies would not fit in
+ * budget_mb megabytes are skipped
+ */
+int main (int argc, char* argv[]) {
+    const std::size_t max_n  = (argc > 1) ? static_cast<std::size_t>(std::atof(argv[1])) : 100000000;
+    const std::size_t budget = ((argc > 2) ? static_cast<std::size_t>(std::atof(argv[2])) : 2048) << 20;
+    reporter r;
+    bench_all(my_types(), r, max_n, budget);
+    return 0;}
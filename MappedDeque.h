@@ -0,0 +1,470 @@
+// ----------------------------
+// projects/deque/MappedDeque.h
+// ----------------------------
+
+#ifndef MappedDeque_h
+#define MappedDeque_h
+
+// --------
+// includes
+// --------
+
+#include <algorithm>        // max, min
+#include <cassert>          // assert
+#include <cerrno>           // errno
+#include <cstddef>          // size_t
+#include <cstdint>          // uint64_t
+#include <cstring>          // memcmp, memcpy, memset
+#include <new>              // placement new
+#include <stdexcept>        // length_error, out_of_range, runtime_error
+#include <system_error>     // system_error, system_category
+#include <type_traits>      // is_trivially_copyable
+
+#include <fcntl.h>          // open
+#include <sys/mman.h>       // madvise, mmap, msync, munmap
+#include <sys/stat.h>       // fstat
+#include <unistd.h>         // close, ftruncate, pread, sysconf
+
+// ------------
+// mapped_deque
+// ------------
+
+/**
+ * deque whose blocks are pieces of a memory-mapped file, for queues larger
+ * than memory; POSIX only
+ * the file starts with a header holding the head and tail positions, the
+ * block map and the free block stack, then the blocks; the map is a ring of
+ * max_blocks slots, logical block L lives in slot L % max_blocks
+ * the blocks at the head and the tail are advised sequential and the next
+ * one to be read is prefetched, blocks in the middle get no advice and are
+ * left to the page cache to evict, drained blocks are dropped and reused
+ * reopening the file resumes the queue at its old head and tail
+ * T must be trivially copyable, the elements are stored as their bytes
+ */
+template <typename T>
+class mapped_deque {
+    static_assert(std::is_trivially_copyable<T>::value, "mapped_deque needs a trivially copyable T");
+
+    public:
+        // --------
+        // typedefs
+        // --------
+
+        typedef T           value_type;
+        typedef std::size_t size_type;
+        typedef T&          reference;
+        typedef const T&    const_reference;
+
+        static const size_type DEFAULT_BLOCK_BYTES = 1 << 20;
+        static const size_type DEFAULT_MAX_BLOCKS  = 1 << 18;
+
+    private:
+        typedef std::uint64_t word;
+
+        // ------
+        // header
+        // ------
+
+        struct header {
+            char magic[8];
+            word element_size;
+            word block_bytes;
+            word max_blocks;
+            word file_blocks;     // blocks the file has room for
+            word used_blocks;     // blocks ever handed out, the rest of the room is untouched
+            word free_count;      // entries on the free stack
+            word head;            // position of the first element
+            word tail;};          // position one past the last element
+                                  // followed by word map[max_blocks], then word free[max_blocks]
+
+        static const word START = word(1) << 62;   // first position, far from 0 in both directions
+
+        // ----
+        // data
+        // ----
+
+        int       _fd;
+        char*     _base;          // the whole file's worth of address space, mapped at once
+        size_type _mapped;
+        header*   _h;
+        word*     _map;           // slot + 1 of each logical block's file block, 0 for none
+        word*     _free;
+        char*     _blocks;
+        size_type _per_block;     // elements in one block
+
+        mapped_deque (const mapped_deque&);
+        mapped_deque& operator = (const mapped_deque&);
+
+        static const char* magic () {
+            return "mdeque1";}
+
+        static size_type page () {
+            return static_cast<size_type>(::sysconf(_SC_PAGESIZE));}
+
+        static size_type round_up (size_type n, size_type p) {
+            return (n + p - 1) / p * p;}
+
+        static void fail (const char* what) {
+            throw std::system_error(errno, std::system_category(), what);}
+
+        /**
+         * @param max_blocks - slots in the block map
+         * @return bytes before the first block
+         */
+        static size_type header_bytes (size_type max_blocks) {
+            return round_up(sizeof(header) + 2 * max_blocks * sizeof(word), page());}
+
+        // -----
+        // valid
+        // -----
+
+        bool valid () const {
+            return _h && (_h->head <= _h->tail) &&
+                   (_h->free_count <= _h->used_blocks) && (_h->used_blocks <= _h->file_blocks);}
+
+        // -----
+        // block
+        // -----
+
+        /**
+         * @param l - logical block
+         * @return start of the file block holding l
+         */
+        char* block (word l) const {
+            const word s = _map[l % _h->max_blocks];
+            assert(s);
+            return _blocks + (s - 1) * _h->block_bytes;}
+
+        /**
+         * @param p - position
+         * @return storage of the element at p
+         */
+        T* element (word p) const {
+            return reinterpret_cast<T*>(block(p / _per_block)) + p % _per_block;}
+
+        /**
+         * @param l - logical block
+         * @param advice - madvise advice for it
+         */
+        void advise (word l, int advice) const {
+            ::madvise(block(l), _h->block_bytes, advice);}
+
+        // --------------
+        // allocate_block
+        // --------------
+
+        /**
+         * @param l - logical block about to get its first element, an empty
+         * deque holds no blocks and a nonempty one exactly those its elements
+         * span
+         * gives l a file block, from the free stack or from the end of the
+         * file, which grows by doubling
+         */
+        void allocate_block (word l) {
+            const word first = ((_h->head == _h->tail) ? l : std::min(l, _h->head / _per_block));
+            const word last  = ((_h->head == _h->tail) ? l : std::max(l, (_h->tail - 1) / _per_block));
+            if (last - first >= _h->max_blocks)
+                throw std::length_error("mapped_deque block map is full");
+            word s;
+            if (_h->free_count)
+                s = _free[--_h->free_count];
+            else {
+                if (_h->used_blocks == _h->file_blocks) {
+                    const word n = std::min<word>(std::max<word>(2 * _h->file_blocks, 1), _h->max_blocks);
+                    if (::ftruncate(_fd, header_bytes(_h->max_blocks) + n * _h->block_bytes) != 0)
+                        fail("mapped_deque ftruncate");
+                    _h->file_blocks = n;}
+                s = _h->used_blocks++;}
+            _map[l % _h->max_blocks] = s + 1;
+            advise(l, MADV_SEQUENTIAL);}
+
+        // -------------
+        // release_block
+        // -------------
+
+        /**
+         * @param l - logical block that no longer holds an element
+         * drops its pages and puts its file block on the free stack
+         */
+        void release_block (word l) {
+            word& e = _map[l % _h->max_blocks];
+            advise(l, MADV_DONTNEED);
+            _free[_h->free_count++] = e - 1;
+            e = 0;}
+
+        // ----
+        // open
+        // ----
+
+        /**
+         * @param block_bytes - block size for a new file
+         * @param max_blocks - block map slots for a new file
+         * maps the file, writing a fresh header when it is empty
+         */
+        void open (size_type block_bytes, size_type max_blocks) {
+            struct stat st;
+            if (::fstat(_fd, &st) != 0)
+                fail("mapped_deque fstat");
+            header h;
+            if (st.st_size == 0) {
+                std::memset(&h, 0, sizeof(h));
+                std::memcpy(h.magic, magic(), sizeof(h.magic));
+                h.element_size = sizeof(T);
+                h.block_bytes  = round_up(std::max(block_bytes, sizeof(T)), page());
+                h.max_blocks   = max_blocks;
+                h.head = h.tail = START;
+                if (::ftruncate(_fd, header_bytes(max_blocks)) != 0)
+                    fail("mapped_deque ftruncate");}
+            else if (::pread(_fd, &h, sizeof(h), 0) != static_cast<ssize_t>(sizeof(h)))
+                fail("mapped_deque pread");
+            if ((std::memcmp(h.magic, magic(), sizeof(h.magic)) != 0) || (h.element_size != sizeof(T)))
+                throw std::runtime_error("mapped_deque file does not hold this element type");
+            _mapped = header_bytes(h.max_blocks) + h.max_blocks * h.block_bytes;
+            void* p = ::mmap(0, _mapped, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_NORESERVE, _fd, 0);
+            if (p == MAP_FAILED)
+                fail("mapped_deque mmap");
+            _base      = static_cast<char*>(p);
+            _h         = reinterpret_cast<header*>(_base);
+            _map       = reinterpret_cast<word*>(_base + sizeof(header));
+            _free      = _map + h.max_blocks;
+            _blocks    = _base + header_bytes(h.max_blocks);
+            if (st.st_size == 0)
+                std::memcpy(_h, &h, sizeof(h));
+            _per_block = _h->block_bytes / sizeof(T);}
+
+    public:
+        // ------------
+        // constructors
+        // ------------
+
+        /**
+         * @param path - file to open, created when it does not exist
+         * @param block_bytes - bytes per block, rounded up to whole pages,
+         * used only when the file is new
+         * @param max_blocks - most blocks the queue can span at once, used
+         * only when the file is new
+         * @throws system_error when the file cannot be opened or mapped,
+         * runtime_error when it holds some other kind of deque
+         */
+        explicit mapped_deque (const char* path, size_type block_bytes = DEFAULT_BLOCK_BYTES, size_type max_blocks = DEFAULT_MAX_BLOCKS) :
+                _fd(-1), _base(0), _mapped(0), _h(0), _map(0), _free(0), _blocks(0), _per_block(0) {
+            _fd = ::open(path, O_RDWR | O_CREAT, 0644);
+            if (_fd < 0)
+                fail("mapped_deque open");
+            try {
+                open(block_bytes, max_blocks);}
+            catch (...) {
+                if (_base)
+                    ::munmap(_base, _mapped);
+                ::close(_fd);
+                throw;}
+            assert(valid());}
+
+        // ----------
+        // destructor
+        // ----------
+
+        /**
+         * unmaps the file, the kernel writes back whatever is dirty
+         */
+        ~mapped_deque () {
+            ::munmap(_base, _mapped);
+            ::close(_fd);}
+
+        // -----------
+        // operator []
+        // -----------
+
+        /**
+         * @param i - index relative to the front
+         * @return reference to element i, unchecked
+         */
+        reference operator [] (size_type i) {
+            assert(i < size());
+            return *element(_h->head + i);}
+
+        const_reference operator [] (size_type i) const {
+            assert(i < size());
+            return *element(_h->head + i);}
+
+        // --
+        // at
+        // --
+
+        reference at (size_type i) {
+            if (i >= size())
+                throw std::out_of_range("mapped_deque::at index out of range");
+            return (*this)[i];}
+
+        const_reference at (size_type i) const {
+            if (i >= size())
+                throw std::out_of_range("mapped_deque::at index out of range");
+            return (*this)[i];}
+
+        // ----
+        // back
+        // ----
+
+        reference back () {
+            assert(!empty());
+            return *element(_h->tail - 1);}
+
+        const_reference back () const {
+            assert(!empty());
+            return *element(_h->tail - 1);}
+
+        // -----------
+        // block_bytes
+        // -----------
+
+        size_type block_bytes () const {
+            return _h->block_bytes;}
+
+        // -----
+        // clear
+        // -----
+
+        /**
+         * releases every block and starts over in the middle
+         */
+        void clear () {
+            if (!empty())
+                for (word l = _h->head / _per_block; l <= (_h->tail - 1) / _per_block; ++l)
+                    release_block(l);
+            _h->head = _h->tail = START;}
+
+        // -----
+        // empty
+        // -----
+
+        bool empty () const {
+            return _h->head == _h->tail;}
+
+        // -----------
+        // file_blocks
+        // -----------
+
+        /**
+         * @return blocks the file has room for, a measure of its size
+         */
+        size_type file_blocks () const {
+            return _h->file_blocks;}
+
+        // -----
+        // front
+        // -----
+
+        reference front () {
+            assert(!empty());
+            return *element(_h->head);}
+
+        const_reference front () const {
+            assert(!empty());
+            return *element(_h->head);}
+
+        // ----------
+        // max_blocks
+        // ----------
+
+        size_type max_blocks () const {
+            return _h->max_blocks;}
+
+        // --------
+        // pop_back
+        // --------
+
+        /**
+         * releases the block the last element leaves empty and prefetches
+         * the new tail block
+         */
+        void pop_back () {
+            assert(!empty());
+            const word l = (_h->tail - 1) / _per_block;
+            --_h->tail;
+            if (empty() || ((_h->tail - 1) / _per_block != l)) {
+                release_block(l);
+                if (!empty())
+                    advise(l - 1, MADV_WILLNEED);}
+            assert(valid());}
+
+        // ---------
+        // pop_front
+        // ---------
+
+        /**
+         * releases the block the first element leaves empty and prefetches
+         * the new head block
+         */
+        void pop_front () {
+            assert(!empty());
+            const word l = _h->head / _per_block;
+            ++_h->head;
+            if (empty() || (_h->head / _per_block != l)) {
+                release_block(l);
+                if (!empty())
+                    advise(l + 1, MADV_WILLNEED);}
+            assert(valid());}
+
+        // ---------
+        // push_back
+        // ---------
+
+        /**
+         * @param v - value to append
+         * @throws length_error when the queue would span more than
+         * max_blocks blocks
+         */
+        void push_back (const_reference v) {
+            const word p = _h->tail;
+            if (empty() || (p % _per_block == 0))
+                allocate_block(p / _per_block);
+            ::new (static_cast<void*>(element(p))) T(v);
+            ++_h->tail;
+            assert(valid());}
+
+        // ----------
+        // push_front
+        // ----------
+
+        /**
+         * @param v - value to prepend
+         * @throws length_error when the queue would span more than
+         * max_blocks blocks
+         */
+        void push_front (const_reference v) {
+            const word p = _h->head - 1;
+            if (empty() || (p % _per_block == _per_block - 1))
+                allocate_block(p / _per_block);
+            ::new (static_cast<void*>(element(p))) T(v);
+            --_h->head;
+            assert(valid());}
+
+        // ----
+        // size
+        // ----
+
+        size_type size () const {
+            return _h->tail - _h->head;}
+
+        // ----
+        // sync
+        // ----
+
+        /**
+         * writes the header and every dirty block to the file and waits
+         * @throws system_error when that fails
+         */
+        void sync () {
+            if (::msync(_base, header_bytes(_h->max_blocks) + _h->file_blocks * _h->block_bytes, MS_SYNC) != 0)
+                fail("mapped_deque msync");}};
+
+template <typename T>
+const typename mapped_deque<T>::size_type mapped_deque<T>::DEFAULT_BLOCK_BYTES;
+
+template <typename T>
+const typename mapped_deque<T>::size_type mapped_deque<T>::DEFAULT_MAX_BLOCKS;
+
+template <typename T>
+const typename mapped_deque<T>::word mapped_deque<T>::START;
+
+#endif // MappedDeque_h
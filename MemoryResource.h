@@ -0,0 +1,279 @@
+// -------------------------------
+// projects/deque/MemoryResource.h
+// -------------------------------
+
+#ifndef MemoryResource_h
+#define MemoryResource_h
+
+// --------
+// includes
+// --------
+
+#include <cassert> // assert
+#include <cstddef> // max_align_t, size_t
+#include <cstdint> // uintptr_t
+#include <new>     // bad_alloc, operator delete, operator new
+
+// ---------------
+// memory_resource
+// ---------------
+
+/**
+ * source of raw memory behind a polymorphic_allocator
+ * shaped after std::pmr::memory_resource, which needs C++17
+ */
+class memory_resource {
+    public:
+        static const std::size_t max_align = alignof(std::max_align_t);
+
+        virtual ~memory_resource () {}
+
+        /**
+         * @param bytes - size of the storage
+         * @param alignment - power of two the address is a multiple of
+         * @return pointer to the storage
+         */
+        void* allocate (std::size_t bytes, std::size_t alignment = max_align) {
+            return do_allocate(bytes, alignment);}
+
+        /**
+         * @param p - storage from allocate
+         * @param bytes - size it was allocated with
+         * @param alignment - alignment it was allocated with
+         */
+        void deallocate (void* p, std::size_t bytes, std::size_t alignment = max_align) {
+            do_deallocate(p, bytes, alignment);}
+
+        /**
+         * @param that - resource to compare with
+         * @return whether storage from one can be deallocated by the other
+         */
+        bool is_equal (const memory_resource& that) const noexcept {
+            return do_is_equal(that);}
+
+    private:
+        virtual void* do_allocate   (std::size_t bytes, std::size_t alignment) = 0;
+        virtual void  do_deallocate (void* p, std::size_t bytes, std::size_t alignment) = 0;
+        virtual bool  do_is_equal   (const memory_resource& that) const noexcept = 0;};
+
+inline bool operator == (const memory_resource& lhs, const memory_resource& rhs) {
+    return (&lhs == &rhs) || lhs.is_equal(rhs);}
+
+inline bool operator != (const memory_resource& lhs, const memory_resource& rhs) {
+    return !(lhs == rhs);}
+
+// -------------------
+// new_delete_resource
+// -------------------
+
+/**
+ * @return the resource that forwards to global operator new and delete
+ */
+inline memory_resource* new_delete_resource () {
+    struct new_delete : memory_resource {
+        void* do_allocate (std::size_t bytes, std::size_t alignment) {
+            assert(alignment <= max_align);
+            return ::operator new(bytes);}
+
+        void do_deallocate (void* p, std::size_t, std::size_t) {
+            ::operator delete(p);}
+
+        bool do_is_equal (const memory_resource& that) const noexcept {
+            return this == &that;}};
+    static new_delete r;
+    return &r;}
+
+// --------------------
+// get_default_resource
+// --------------------
+
+inline memory_resource*& default_resource () {
+    static memory_resource* r = new_delete_resource();
+    return r;}
+
+/**
+ * @return the resource a default constructed polymorphic_allocator uses
+ */
+inline memory_resource* get_default_resource () {
+    return default_resource();}
+
+/**
+ * @param r - new default, null restores new_delete_resource()
+ * @return the previous default
+ */
+inline memory_resource* set_default_resource (memory_resource* r) {
+    memory_resource* old = default_resource();
+    default_resource() = r ? r : new_delete_resource();
+    return old;}
+
+// -------------------------
+// monotonic_buffer_resource
+// -------------------------
+
+/**
+ * arena: hands out memory by bumping a pointer through a buffer and through
+ * chunks from an upstream resource, each twice the size of the last
+ * deallocate does nothing, everything is given back at once by release or
+ * by the destructor
+ */
+class monotonic_buffer_resource : public memory_resource {
+    private:
+        struct chunk {
+            chunk*      next;
+            std::size_t bytes;};
+
+        memory_resource* _upstream;
+        void*            _initial;       // caller's buffer, never freed
+        std::size_t      _initial_bytes;
+        chunk*           _chunks;        // chunks from upstream, newest first
+        char*            _current;
+        std::size_t      _space;
+        std::size_t      _next_bytes;
+
+        monotonic_buffer_resource (const monotonic_buffer_resource&);
+        monotonic_buffer_resource& operator = (const monotonic_buffer_resource&);
+
+        /**
+         * @param bytes - size of the request that did not fit
+         * takes a new chunk from upstream large enough for bytes
+         */
+        void grow (std::size_t bytes) {
+            std::size_t n = _next_bytes;
+            while (n < bytes + sizeof(chunk) + max_align)
+                n *= 2;
+            chunk* c  = static_cast<chunk*>(_upstream->allocate(n, max_align));
+            c->next   = _chunks;
+            c->bytes  = n;
+            _chunks   = c;
+            _current  = reinterpret_cast<char*>(c) + sizeof(chunk);
+            _space    = n - sizeof(chunk);
+            _next_bytes = n * 2;}
+
+        void* do_allocate (std::size_t bytes, std::size_t alignment) {
+            std::size_t pad = (alignment - reinterpret_cast<std::uintptr_t>(_current) % alignment) % alignment;
+            if (!_current || (pad + bytes > _space)) {
+                grow(bytes + alignment);
+                pad = (alignment - reinterpret_cast<std::uintptr_t>(_current) % alignment) % alignment;}
+            char* p   = _current + pad;
+            _current  = p + bytes;
+            _space   -= pad + bytes;
+            return p;}
+
+        void do_deallocate (void*, std::size_t, std::size_t) {}
+
+        bool do_is_equal (const memory_resource& that) const noexcept {
+            return this == &that;}
+
+    public:
+        static const std::size_t DEFAULT_CHUNK_BYTES = 1024;
+
+        /**
+         * @param upstream - where the chunks come from
+         */
+        explicit monotonic_buffer_resource (memory_resource* upstream = get_default_resource()) :
+                _upstream(upstream), _initial(0), _initial_bytes(0), _chunks(0),
+                _current(0), _space(0), _next_bytes(DEFAULT_CHUNK_BYTES) {}
+
+        /**
+         * @param initial_bytes - size of the first chunk
+         * @param upstream - where the chunks come from
+         */
+        explicit monotonic_buffer_resource (std::size_t initial_bytes, memory_resource* upstream = get_default_resource()) :
+                _upstream(upstream), _initial(0), _initial_bytes(0), _chunks(0),
+                _current(0), _space(0), _next_bytes(initial_bytes ? initial_bytes : 1) {}
+
+        /**
+         * @param buffer - storage used before asking upstream
+         * @param bytes - size of buffer
+         * @param upstream - where the chunks come from once buffer is used up
+         */
+        monotonic_buffer_resource (void* buffer, std::size_t bytes, memory_resource* upstream = get_default_resource()) :
+                _upstream(upstream), _initial(buffer), _initial_bytes(bytes), _chunks(0),
+                _current(static_cast<char*>(buffer)), _space(bytes), _next_bytes(bytes ? bytes * 2 : DEFAULT_CHUNK_BYTES) {}
+
+        ~monotonic_buffer_resource () {
+            release();}
+
+        /**
+         * gives every chunk back to upstream and starts over at the buffer
+         */
+        void release () {
+            while (_chunks) {
+                chunk* c = _chunks;
+                _chunks  = c->next;
+                _upstream->deallocate(c, c->bytes, max_align);}
+            _current = static_cast<char*>(_initial);
+            _space   = _initial_bytes;}
+
+        /**
+         * @return where the chunks come from
+         */
+        memory_resource* upstream_resource () const {
+            return _upstream;}};
+
+// ---------------------
+// polymorphic_allocator
+// ---------------------
+
+/**
+ * allocator that forwards to a memory_resource chosen at run time, so
+ * containers using different resources still have the same type
+ * it never propagates: a copy of a container uses the default resource and
+ * assignment and swap leave each container on its own resource
+ */
+template <typename T>
+class polymorphic_allocator {
+    template <typename U>
+    friend class polymorphic_allocator;
+
+    private:
+        memory_resource* _r;
+
+    public:
+        typedef T value_type;
+
+        polymorphic_allocator () noexcept :
+                _r(get_default_resource()) {}
+
+        polymorphic_allocator (memory_resource* r) noexcept :
+                _r(r) {
+            assert(r);}
+
+        template <typename U>
+        polymorphic_allocator (const polymorphic_allocator<U>& that) noexcept :
+                _r(that._r) {}
+
+        /**
+         * @param n - number of objects
+         * @return uninitialized storage for n objects
+         */
+        T* allocate (std::size_t n) {
+            if (n > std::size_t(-1) / sizeof(T))
+                throw std::bad_alloc();
+            return static_cast<T*>(_r->allocate(n * sizeof(T), alignof(T)));}
+
+        /**
+         * @param p - storage from allocate
+         * @param n - number of objects it was allocated for
+         */
+        void deallocate (T* p, std::size_t n) {
+            _r->deallocate(p, n * sizeof(T), alignof(T));}
+
+        /**
+         * @return allocator on the default resource, for container copies
+         */
+        polymorphic_allocator select_on_container_copy_construction () const {
+            return polymorphic_allocator();}
+
+        memory_resource* resource () const {
+            return _r;}};
+
+template <typename T, typename U>
+inline bool operator == (const polymorphic_allocator<T>& lhs, const polymorphic_allocator<U>& rhs) {
+    return *lhs.resource() == *rhs.resource();}
+
+template <typename T, typename U>
+inline bool operator != (const polymorphic_allocator<T>& lhs, const polymorphic_allocator<U>& rhs) {
+    return !(lhs == rhs);}
+
+#endif // MemoryResource_h
@@ -0,0 +1,515 @@
+// --------------------------
+// projects/deque/RingDeque.h
+// --------------------------
+
+#ifndef RingDeque_h
+#define RingDeque_h
+
+// --------
+// includes
+// --------
+
+#include <algorithm>        // min
+#include <cassert>          // assert
+#include <cstddef>          // ptrdiff_t, size_t
+#include <iterator>         // random_access_iterator_tag
+#include <memory>           // allocator, allocator_traits
+#include <stdexcept>        // out_of_range
+#include <type_traits>      // conditional, is_const
+#include <utility>          // move, pair, swap
+
+#include "Deque.h"
+
+// ----------
+// ring_deque
+// ----------
+
+/**
+ * bounded deque for sliding windows and recent history: its capacity is
+ * fixed at construction, where all of its storage is allocated at once
+ * pushing onto a full ring overwrites instead of growing: push_back
+ * replaces the oldest element, the front, and push_front replaces the
+ * newest, the back; overwritten() counts them
+ * the elements sit in one circular buffer, which spans() hands out as at
+ * most two contiguous segments, oldest first
+ */
+template < typename T, typename A = std::allocator<T> >
+class ring_deque {
+    public:
+        // --------
+        // typedefs
+        // --------
+
+        typedef A                                     allocator_type;
+        typedef std::allocator_traits<allocator_type> alloc_traits;
+        typedef typename alloc_traits::value_type     value_type;
+        typedef typename alloc_traits::size_type      size_type;
+        typedef typename alloc_traits::difference_type difference_type;
+        typedef typename alloc_traits::pointer        pointer;
+        typedef typename alloc_traits::const_pointer  const_pointer;
+        typedef value_type&                           reference;
+        typedef const value_type&                     const_reference;
+
+        typedef std::pair<segment<pointer>, segment<pointer> >             span_pair;
+        typedef std::pair<segment<const_pointer>, segment<const_pointer> > const_span_pair;
+
+    private:
+        // ----
+        // data
+        // ----
+
+        allocator_type _a;
+        pointer        _data;
+        size_type      _capacity;
+        size_type      _head;          // slot of the front
+        size_type      _size;
+        size_type      _overwritten;
+
+        // -----
+        // valid
+        // -----
+
+        bool valid () const {
+            return (_size <= _capacity) && ((_capacity == 0) || (_head < _capacity));}
+
+        // --------
+        // physical
+        // --------
+
+        /**
+         * @param i - index relative to the front
+         * @return slot holding element i
+         */
+        size_type physical (size_type i) const {
+            return (i < _capacity - _head) ? (_head + i) : (_head + i - _capacity);}
+
+        /**
+         * @param s - slot
+         * @return the slot before s, circularly
+         */
+        size_type previous (size_type s) const {
+            return (s == 0) ? (_capacity - 1) : (s - 1);}
+
+    public:
+        // --------------
+        // basic_iterator
+        // --------------
+
+        /**
+         * random access iterator holding the ring and an index, R is
+         * ring_deque or const ring_deque
+         */
+        template <typename R>
+        class basic_iterator {
+            public:
+                typedef std::random_access_iterator_tag iterator_category;
+                typedef typename ring_deque::value_type      value_type;
+                typedef typename ring_deque::difference_type difference_type;
+                typedef typename std::conditional<std::is_const<R>::value, const T*, T*>::type pointer;
+                typedef typename std::conditional<std::is_const<R>::value, const T&, T&>::type reference;
+
+            private:
+                R*        _r;
+                size_type _i;
+
+            public:
+                basic_iterator () :
+                        _r(0), _i(0) {}
+
+                basic_iterator (R* r, size_type i) :
+                        _r(r), _i(i) {}
+
+                /**
+                 * the conversion from iterator to const_iterator
+                 */
+                template <typename S>
+                basic_iterator (const basic_iterator<S>& that,
+                        typename std::enable_if<std::is_const<R>::value && !std::is_const<S>::value>::type* = 0) :
+                        _r(that.container()), _i(that.index()) {}
+
+                R* container () const {
+                    return _r;}
+
+                size_type index () const {
+                    return _i;}
+
+                friend bool operator == (const basic_iterator& lhs, const basic_iterator& rhs) {
+                    return (lhs._r == rhs._r) && (lhs._i == rhs._i);}
+
+                friend bool operator != (const basic_iterator& lhs, const basic_iterator& rhs) {
+                    return !(lhs == rhs);}
+
+                friend bool operator < (const basic_iterator& lhs, const basic_iterator& rhs) {
+                    return lhs._i < rhs._i;}
+
+                friend bool operator > (const basic_iterator& lhs, const basic_iterator& rhs) {
+                    return rhs < lhs;}
+
+                friend bool operator <= (const basic_iterator& lhs, const basic_iterator& rhs) {
+                    return !(rhs < lhs);}
+
+                friend bool operator >= (const basic_iterator& lhs, const basic_iterator& rhs) {
+                    return !(lhs < rhs);}
+
+                friend basic_iterator operator + (basic_iterator lhs, difference_type d) {
+                    return lhs += d;}
+
+                friend basic_iterator operator + (difference_type d, basic_iterator rhs) {
+                    return rhs += d;}
+
+                friend basic_iterator operator - (basic_iterator lhs, difference_type d) {
+                    return lhs -= d;}
+
+                friend difference_type operator - (const basic_iterator& lhs, const basic_iterator& rhs) {
+                    return difference_type(lhs._i) - difference_type(rhs._i);}
+
+                reference operator * () const {
+                    return (*_r)[_i];}
+
+                pointer operator -> () const {
+                    return &**this;}
+
+                reference operator [] (difference_type d) const {
+                    return (*_r)[_i + d];}
+
+                basic_iterator& operator ++ () {
+                    ++_i;
+                    return *this;}
+
+                basic_iterator operator ++ (int) {
+                    basic_iterator x = *this;
+                    ++_i;
+                    return x;}
+
+                basic_iterator& operator -- () {
+                    --_i;
+                    return *this;}
+
+                basic_iterator operator -- (int) {
+                    basic_iterator x = *this;
+                    --_i;
+                    return x;}
+
+                basic_iterator& operator += (difference_type d) {
+                    _i += d;
+                    return *this;}
+
+                basic_iterator& operator -= (difference_type d) {
+                    _i -= d;
+                    return *this;}};
+
+        typedef basic_iterator<ring_deque>       iterator;
+        typedef basic_iterator<const ring_deque> const_iterator;
+
+        // ------------
+        // constructors
+        // ------------
+
+        /**
+         * @param capacity - most elements the ring holds
+         * @param a - allocator - defaulted
+         * allocates all the storage the ring will ever use
+         */
+        explicit ring_deque (size_type capacity, const allocator_type& a = allocator_type()) :
+                _a(a), _data(0), _capacity(capacity), _head(0), _size(0), _overwritten(0) {
+            if (_capacity)
+                _data = alloc_traits::allocate(_a, _capacity);
+            assert(valid());}
+
+        /**
+         * @param that - ring to copy, capacity and counter included
+         */
+        ring_deque (const ring_deque& that) :
+                _a(alloc_traits::select_on_container_copy_construction(that._a)),
+                _data(0), _capacity(that._capacity), _head(0), _size(0), _overwritten(that._overwritten) {
+            if (_capacity)
+                _data = alloc_traits::allocate(_a, _capacity);
+            try {
+                for (; _size != that._size; ++_size)
+                    alloc_traits::construct(_a, _data + _size, that[_size]);}
+            catch (...) {
+                clear();
+                if (_data)
+                    alloc_traits::deallocate(_a, _data, _capacity);
+                throw;}
+            assert(valid());}
+
+        /**
+         * @param that - ring to move from, left with no capacity
+         */
+        ring_deque (ring_deque&& that) noexcept :
+                _a(std::move(that._a)), _data(that._data), _capacity(that._capacity),
+                _head(that._head), _size(that._size), _overwritten(that._overwritten) {
+            that._data     = 0;
+            that._capacity = that._head = that._size = 0;}
+
+        // ----------
+        // destructor
+        // ----------
+
+        ~ring_deque () {
+            clear();
+            if (_data)
+                alloc_traits::deallocate(_a, _data, _capacity);}
+
+        // ----------
+        // operator =
+        // ----------
+
+        /**
+         * @param rhs - ring to copy, capacity and counter included
+         */
+        ring_deque& operator = (ring_deque rhs) {
+            swap(rhs);
+            return *this;}
+
+        // -----------
+        // operator []
+        // -----------
+
+        /**
+         * @param i - index relative to the front, the oldest element
+         * @return reference to element i, unchecked
+         */
+        reference operator [] (size_type i) {
+            assert(i < _size);
+            return _data[physical(i)];}
+
+        const_reference operator [] (size_type i) const {
+            assert(i < _size);
+            return _data[physical(i)];}
+
+        // --
+        // at
+        // --
+
+        reference at (size_type i) {
+            if (i >= _size)
+                throw std::out_of_range("ring_deque::at index out of range");
+            return (*this)[i];}
+
+        const_reference at (size_type i) const {
+            if (i >= _size)
+                throw std::out_of_range("ring_deque::at index out of range");
+            return (*this)[i];}
+
+        // ----
+        // back
+        // ----
+
+        reference back () {
+            assert(!empty());
+            return (*this)[_size - 1];}
+
+        const_reference back () const {
+            assert(!empty());
+            return (*this)[_size - 1];}
+
+        // -----
+        // begin
+        // -----
+
+        iterator begin () {
+            return iterator(this, 0);}
+
+        const_iterator begin () const {
+            return const_iterator(this, 0);}
+
+        // --------
+        // capacity
+        // --------
+
+        size_type capacity () const {
+            return _capacity;}
+
+        // -----
+        // clear
+        // -----
+
+        /**
+         * destroys every element, the storage and the counter stay
+         */
+        void clear () {
+            while (_size)
+                pop_back();
+            _head = 0;}
+
+        // -----
+        // empty
+        // -----
+
+        bool empty () const {
+            return _size == 0;}
+
+        // ---
+        // end
+        // ---
+
+        iterator end () {
+            return iterator(this, _size);}
+
+        const_iterator end () const {
+            return const_iterator(this, _size);}
+
+        // -----
+        // front
+        // -----
+
+        reference front () {
+            assert(!empty());
+            return (*this)[0];}
+
+        const_reference front () const {
+            assert(!empty());
+            return (*this)[0];}
+
+        // ----
+        // full
+        // ----
+
+        bool full () const {
+            return _size == _capacity;}
+
+        // -------------
+        // get_allocator
+        // -------------
+
+        allocator_type get_allocator () const {
+            return _a;}
+
+        // -----------
+        // overwritten
+        // -----------
+
+        /**
+         * @return number of elements pushes have overwritten so far
+         */
+        size_type overwritten () const {
+            return _overwritten;}
+
+        // --------
+        // pop_back
+        // --------
+
+        void pop_back () {
+            assert(!empty());
+            --_size;
+            alloc_traits::destroy(_a, _data + physical(_size));}
+
+        // ---------
+        // pop_front
+        // ---------
+
+        void pop_front () {
+            assert(!empty());
+            alloc_traits::destroy(_a, _data + _head);
+            _head = (_head + 1 == _capacity) ? 0 : (_head + 1);
+            --_size;}
+
+        // ---------
+        // push_back
+        // ---------
+
+        /**
+         * @param v - value to append
+         * a full ring overwrites its front, the oldest element, and the
+         * next element becomes the front
+         */
+        void push_back (const_reference v) {
+            emplace_back(v);}
+
+        void push_back (value_type&& v) {
+            emplace_back(std::move(v));}
+
+        /**
+         * @param args - constructor arguments for the new back
+         */
+        template <typename... Args>
+        void emplace_back (Args&&... args) {
+            if (_capacity == 0)
+                return;
+            if (full()) {
+                _data[_head] = value_type(std::forward<Args>(args)...);
+                _head = (_head + 1 == _capacity) ? 0 : (_head + 1);
+                ++_overwritten;}
+            else {
+                alloc_traits::construct(_a, _data + physical(_size), std::forward<Args>(args)...);
+                ++_size;}
+            assert(valid());}
+
+        // ----------
+        // push_front
+        // ----------
+
+        /**
+         * @param v - value to prepend
+         * a full ring overwrites its back, the newest element, and v
+         * becomes the front
+         */
+        void push_front (const_reference v) {
+            emplace_front(v);}
+
+        void push_front (value_type&& v) {
+            emplace_front(std::move(v));}
+
+        /**
+         * @param args - constructor arguments for the new front
+         */
+        template <typename... Args>
+        void emplace_front (Args&&... args) {
+            if (_capacity == 0)
+                return;
+            const size_type h = previous(_head);
+            if (full()) {
+                _data[h] = value_type(std::forward<Args>(args)...);
+                ++_overwritten;}
+            else {
+                alloc_traits::construct(_a, _data + h, std::forward<Args>(args)...);
+                ++_size;}
+            _head = h;
+            assert(valid());}
+
+        // ----
+        // size
+        // ----
+
+        size_type size () const {
+            return _size;}
+
+        // -----
+        // spans
+        // -----
+
+        /**
+         * @return the elements, oldest first, as two contiguous segments:
+         * from the front to the end of the buffer, then the wrapped part
+         * from the start of the buffer, which is empty when nothing wraps
+         */
+        span_pair spans () {
+            const size_type n = std::min(_size, _capacity - _head);
+            return span_pair(segment<pointer>(_data + _head, n), segment<pointer>(_data, _size - n));}
+
+        const_span_pair spans () const {
+            const size_type n = std::min(_size, _capacity - _head);
+            return const_span_pair(segment<const_pointer>(_data + _head, n), segment<const_pointer>(_data, _size - n));}
+
+        // ----
+        // swap
+        // ----
+
+        /**
+         * @param that - ring to swap with, in constant time
+         */
+        void swap (ring_deque& that) noexcept {
+            using std::swap;
+            swap(_a,           that._a);
+            swap(_data,        that._data);
+            swap(_capacity,    that._capacity);
+            swap(_head,        that._head);
+            swap(_size,        that._size);
+            swap(_overwritten, that._overwritten);}
+
+        friend void swap (ring_deque& lhs, ring_deque& rhs) noexcept {
+            lhs.swap(rhs);}};
+
+#endif // RingDeque_h
@@ -0,0 +1,291 @@
+// --------------------------
+// projects/deque/SpscDeque.h
+// --------------------------
+
+#ifndef SpscDeque_h
+#define SpscDeque_h
+
+// --------
+// includes
+// --------
+
+#include <atomic>      // atomic, memory_order_acquire, memory_order_relaxed, memory_order_release
+#include <cassert>     // assert
+#include <cstddef>     // size_t
+#include <memory>      // allocator, allocator_traits
+#include <new>         // placement new
+#include <type_traits> // aligned_storage
+#include <utility>     // forward, move
+
+#include "Deque.h"
+
+// ----------
+// spsc_deque
+// ----------
+
+/**
+ * unbounded queue between exactly one producer thread, which calls
+ * push_back and emplace_back, and one consumer thread, which calls
+ * pop_front
+ * the elements sit in blocks sized by the same block policy as my_deque,
+ * linked in order; the producer publishes each element with a release store
+ * of the push count and the consumer retires it with a release store of the
+ * pop count, there are no locks and neither side ever waits
+ * blocks the consumer drains go back to the producer through a lock-free
+ * stack and are reused before anything new is allocated
+ */
+template < typename T, typename A = std::allocator<T>, typename B = block_bytes<> >
+class spsc_deque {
+    public:
+        // --------
+        // typedefs
+        // --------
+
+        typedef A                                     allocator_type;
+        typedef T                                     value_type;
+        typedef std::size_t                           size_type;
+        typedef value_type&                           reference;
+        typedef const value_type&                     const_reference;
+
+        static const size_type DEFAULT_ARRAY_SIZE = B::template elements<T>::value;
+
+    private:
+        struct block {
+            typename std::aligned_storage<sizeof(T), alignof(T)>::type slots[DEFAULT_ARRAY_SIZE];
+            block* next;};   // next block in the queue, or on a free list
+
+        typedef typename std::allocator_traits<allocator_type>::template rebind_alloc<block> block_allocator;
+        typedef std::allocator_traits<block_allocator>                                      block_traits;
+
+        static const size_type CACHE_LINE = 64;
+
+        // ----
+        // data
+        // ----
+
+        block_allocator     _a;
+
+        char                _pad_0[CACHE_LINE];
+        // producer side
+        block*              _tail;           // block holding the next free slot
+        size_type           _tail_index;
+        block*              _free;           // blocks ready for reuse, producer only
+        std::atomic<size_type> _pushed;
+
+        char                _pad_1[CACHE_LINE];
+        // consumer side
+        block*              _head;           // block holding the first element
+        size_type           _head_index;
+        std::atomic<size_type> _popped;
+
+        char                _pad_2[CACHE_LINE];
+        // consumer to producer
+        std::atomic<block*> _returned;       // drained blocks, pushed by the consumer
+
+        spsc_deque (const spsc_deque&);
+        spsc_deque& operator = (const spsc_deque&);
+
+        // -----
+        // valid
+        // -----
+
+        bool valid () const {
+            return _head && _tail && (_head_index <= DEFAULT_ARRAY_SIZE) && (_tail_index <= DEFAULT_ARRAY_SIZE);}
+
+        /**
+         * @param b - block
+         * @param i - slot index
+         * @return the storage of slot i
+         */
+        static T* slot (block* b, size_type i) {
+            return reinterpret_cast<T*>(&b->slots[i]);}
+
+        // --------------
+        // allocate_block
+        // --------------
+
+        /**
+         * @return an empty block, reused if the consumer has handed any back
+         * producer side only
+         */
+        block* allocate_block () {
+            if (!_free)
+                _free = _returned.exchange(0, std::memory_order_acquire);
+            block* b;
+            if (_free) {
+                b     = _free;
+                _free = b->next;}
+            else
+                b = block_traits::allocate(_a, 1);
+            b->next = 0;
+            return b;}
+
+        // ---------
+        // give_back
+        // ---------
+
+        /**
+         * @param b - block the consumer has drained
+         * pushes b where the producer will find it
+         * consumer side only
+         */
+        void give_back (block* b) {
+            block* h = _returned.load(std::memory_order_relaxed);
+            do {
+                b->next = h;}
+            while (!_returned.compare_exchange_weak(h, b, std::memory_order_release, std::memory_order_relaxed));}
+
+        /**
+         * @param b - first block of a list linked through next
+         */
+        void deallocate_list (block* b) {
+            while (b) {
+                block* n = b->next;
+                block_traits::deallocate(_a, b, 1);
+                b = n;}}
+
+    public:
+        // ------------
+        // constructors
+        // ------------
+
+        /**
+         * @param a - allocator - defaulted
+         * constructs an empty queue with one block
+         */
+        explicit spsc_deque (const allocator_type& a = allocator_type()) :
+                _a(a), _tail(0), _tail_index(0), _free(0), _pushed(0),
+                _head(0), _head_index(0), _popped(0), _returned(0) {
+            _head = _tail = allocate_block();
+            assert(valid());}
+
+        // ----------
+        // destructor
+        // ----------
+
+        /**
+         * destroys what was never popped and frees every block
+         * neither thread may still be using the queue
+         */
+        ~spsc_deque () {
+            T* e;
+            while ((e = front()) != 0) {
+                e->~T();
+                advance();}
+            deallocate_list(_head);
+            deallocate_list(_free);
+            deallocate_list(_returned.load(std::memory_order_acquire));}
+
+        // ------------
+        // emplace_back
+        // ------------
+
+        /**
+         * @param args - constructor arguments for the new element
+         * producer side only
+         */
+        template <typename... Args>
+        void emplace_back (Args&&... args) {
+            if (_tail_index == DEFAULT_ARRAY_SIZE) {
+                block* b    = allocate_block();
+                _tail->next = b;
+                _tail       = b;
+                _tail_index = 0;}
+            ::new (static_cast<void*>(slot(_tail, _tail_index))) T(std::forward<Args>(args)...);
+            ++_tail_index;
+            _pushed.store(_pushed.load(std::memory_order_relaxed) + 1, std::memory_order_release);}
+
+        // -----
+        // empty
+        // -----
+
+        /**
+         * @return whether the queue held nothing at the moment of the call
+         */
+        bool empty () const {
+            return size() == 0;}
+
+        // ---------
+        // pop_front
+        // ---------
+
+        /**
+         * @param v - where the first element is moved to
+         * @return false, without waiting, when the queue is empty
+         * consumer side only
+         */
+        bool pop_front (reference v) {
+            T* e = front();
+            if (!e)
+                return false;
+            v = std::move(*e);
+            e->~T();
+            advance();
+            return true;}
+
+        // ---------
+        // push_back
+        // ---------
+
+        /**
+         * @param v - value to append
+         * producer side only
+         */
+        void push_back (const_reference v) {
+            emplace_back(v);}
+
+        void push_back (value_type&& v) {
+            emplace_back(std::move(v));}
+
+        // ----
+        // size
+        // ----
+
+        /**
+         * @return number of elements at the moment of the call, a snapshot
+         * when the other thread is running
+         */
+        size_type size () const {
+            const size_type p = _popped.load(std::memory_order_acquire);
+            return _pushed.load(std::memory_order_acquire) - p;}
+
+    private:
+        // -----
+        // front
+        // -----
+
+        /**
+         * @return the first element, or null when the queue is empty
+         * steps into the next block, handing the drained one back, when the
+         * current one is used up
+         * consumer side only
+         */
+        T* front () {
+            if (_popped.load(std::memory_order_relaxed) == _pushed.load(std::memory_order_acquire))
+                return 0;
+            if (_head_index == DEFAULT_ARRAY_SIZE) {
+                block* d    = _head;
+                _head       = d->next;
+                _head_index = 0;
+                give_back(d);}
+            return slot(_head, _head_index);}
+
+        // -------
+        // advance
+        // -------
+
+        /**
+         * retires the first element, whose storage is already destroyed
+         * consumer side only
+         */
+        void advance () {
+            ++_head_index;
+            _popped.store(_popped.load(std::memory_order_relaxed) + 1, std::memory_order_release);}};
+
+template <typename T, typename A, typename B>
+const typename spsc_deque<T, A, B>::size_type spsc_deque<T, A, B>::DEFAULT_ARRAY_SIZE;
+
+template <typename T, typename A, typename B>
+const typename spsc_deque<T, A, B>::size_type spsc_deque<T, A, B>::CACHE_LINE;
+
+#endif // SpscDeque_h
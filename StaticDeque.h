@@ -0,0 +1,576 @@
+// ----------------------------
+// projects/deque/StaticDeque.h
+// ----------------------------
+
+#ifndef StaticDeque_h
+#define StaticDeque_h
+
+// --------
+// includes
+// --------
+
+#include <cassert>          // assert
+#include <cstddef>          // ptrdiff_t, size_t
+#include <initializer_list> // initializer_list
+#include <iterator>         // random_access_iterator_tag
+#include <new>              // placement new
+#include <stdexcept>        // length_error, out_of_range
+#include <type_traits>      // aligned_storage, conditional, is_const, is_nothrow_move_constructible, is_trivially_*
+#include <utility>          // forward, move
+
+// C++11 constexpr functions cannot change anything, so the members that do
+// are only constexpr from C++14 on
+#if __cplusplus >= 201402L
+#define STATIC_DEQUE_CONSTEXPR14 constexpr
+#else
+#define STATIC_DEQUE_CONSTEXPR14
+#endif
+
+// ---------------
+// overflow_assert
+// ---------------
+
+/**
+ * overflow policy: pushing onto a full static_deque is a bug, it asserts
+ * and, with NDEBUG, the push is dropped and returns false
+ * in a constant expression an overflow with this policy, or with
+ * overflow_throw, does not compile
+ */
+struct overflow_assert {
+    static bool overflow () {
+        assert(!"static_deque overflow");
+        return false;}};
+
+// --------------
+// overflow_throw
+// --------------
+
+/**
+ * overflow policy: pushing onto a full static_deque throws length_error
+ */
+struct overflow_throw {
+    static bool overflow () {
+        throw std::length_error("static_deque overflow");}};
+
+// ---------------
+// overflow_report
+// ---------------
+
+/**
+ * overflow policy: pushing onto a full static_deque does nothing and
+ * returns false
+ */
+struct overflow_report {
+    static constexpr bool overflow () {
+        return false;}};
+
+// --------------------
+// static_deque_storage
+// --------------------
+
+/**
+ * the elements and the two cursors of a static_deque
+ * trivial types live in a plain array, so the deque is a literal type with
+ * a trivial destructor and can be used in constant expressions
+ * everything else lives in raw aligned storage and is constructed in place
+ */
+template <typename T, std::size_t N,
+          bool = std::is_trivially_default_constructible<T>::value && std::is_trivially_destructible<T>::value>
+class static_deque_storage {
+    protected:
+        T           _data[N];
+        std::size_t _head;      // slot of the first element
+        std::size_t _size;
+
+        constexpr static_deque_storage () :
+                _data(), _head(0), _size(0) {}
+
+        STATIC_DEQUE_CONSTEXPR14 T* slot (std::size_t s) {
+            return &_data[s];}
+
+        constexpr const T* slot (std::size_t s) const {
+            return &_data[s];}
+
+        template <typename... Args>
+        STATIC_DEQUE_CONSTEXPR14 void construct (std::size_t s, Args&&... args) {
+            _data[s] = T(std::forward<Args>(args)...);}
+
+        STATIC_DEQUE_CONSTEXPR14 void destroy (std::size_t) {}};
+
+template <typename T, std::size_t N>
+class static_deque_storage<T, N, false> {
+    protected:
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type _data[N];
+        std::size_t _head;
+        std::size_t _size;
+
+        static_deque_storage () :
+                _head(0), _size(0) {}
+
+        static_deque_storage (const static_deque_storage& that) :
+                _head(0), _size(0) {
+            append_all(that);}
+
+        /**
+         * @param that - storage to move from, its elements are left moved from
+         */
+        static_deque_storage (static_deque_storage&& that) noexcept(std::is_nothrow_move_constructible<T>::value) :
+                _head(0), _size(0) {
+            append_all(that);}
+
+        ~static_deque_storage () {
+            destroy_all();}
+
+        static_deque_storage& operator = (const static_deque_storage& rhs) {
+            if (this != &rhs) {
+                destroy_all();
+                append_all(rhs);}
+            return *this;}
+
+        static_deque_storage& operator = (static_deque_storage&& rhs) noexcept(std::is_nothrow_move_constructible<T>::value) {
+            if (this != &rhs) {
+                destroy_all();
+                append_all(rhs);}
+            return *this;}
+
+        /**
+         * @param that - storage whose elements are appended to this empty one
+         * copies the elements of a const that, moves those of a non-const one
+         * if a constructor throws, the elements already built are destroyed
+         * and the exception propagates
+         */
+        template <typename S>
+        void append_all (S& that) {
+            typedef typename std::conditional<std::is_const<S>::value, const T&, T&&>::type R;
+            try {
+                for (; _size != that._size; ++_size)
+                    construct(_size, static_cast<R>(*that.slot((that._head + _size) % N)));}
+            catch (...) {
+                destroy_all();
+                throw;}}
+
+        /**
+         * destroys every element and leaves the storage empty
+         */
+        void destroy_all () {
+            while (_size) {
+                destroy(_head);
+                _head = (_head + 1) % N;
+                --_size;}
+            _head = 0;}
+
+        T* slot (std::size_t s) {
+            return reinterpret_cast<T*>(&_data[s]);}
+
+        const T* slot (std::size_t s) const {
+            return reinterpret_cast<const T*>(&_data[s]);}
+
+        template <typename... Args>
+        void construct (std::size_t s, Args&&... args) {
+            ::new (static_cast<void*>(slot(s))) T(std::forward<Args>(args)...);}
+
+        void destroy (std::size_t s) {
+            slot(s)->~T();}};
+
+// ------------
+// static_deque
+// ------------
+
+/**
+ * deque of at most N elements kept inline as a circular buffer, so it never
+ * allocates; it has the push, pop, access and iterator interface of my_deque
+ * O chooses what a push onto a full deque does: overflow_assert,
+ * overflow_throw or overflow_report, the push returns false when it did
+ * not happen
+ */
+template <typename T, std::size_t N, typename O = overflow_assert>
+class static_deque : private static_deque_storage<T, N> {
+    static_assert(N > 0, "static_deque needs room for at least one element");
+
+    private:
+        typedef static_deque_storage<T, N> storage;
+
+        using storage::_head;
+        using storage::_size;
+        using storage::slot;
+        using storage::construct;
+        using storage::destroy;
+
+    public:
+        // --------
+        // typedefs
+        // --------
+
+        typedef T                 value_type;
+        typedef std::size_t       size_type;
+        typedef std::ptrdiff_t    difference_type;
+        typedef T*                pointer;
+        typedef const T*          const_pointer;
+        typedef T&                reference;
+        typedef const T&          const_reference;
+        typedef O                 overflow_policy;
+
+    private:
+        // --------
+        // physical
+        // --------
+
+        /**
+         * @param i - index relative to the front
+         * @return slot holding element i
+         */
+        constexpr size_type physical (size_type i) const {
+            return (i < N - _head) ? (_head + i) : (_head + i - N);}
+
+        constexpr bool valid () const {
+            return (_head < N) && (_size <= N);}
+
+    public:
+        // --------------
+        // basic_iterator
+        // --------------
+
+        /**
+         * random access iterator holding the deque and an index, D is
+         * static_deque or const static_deque
+         */
+        template <typename D>
+        class basic_iterator {
+            friend class static_deque;
+
+            public:
+                typedef std::random_access_iterator_tag iterator_category;
+                typedef typename static_deque::value_type      value_type;
+                typedef typename static_deque::difference_type difference_type;
+                typedef typename std::conditional<std::is_const<D>::value, const T*, T*>::type pointer;
+                typedef typename std::conditional<std::is_const<D>::value, const T&, T&>::type reference;
+
+            private:
+                D*        _d;
+                size_type _i;
+
+            public:
+                constexpr basic_iterator () :
+                        _d(0), _i(0) {}
+
+                constexpr basic_iterator (D* d, size_type i) :
+                        _d(d), _i(i) {}
+
+                /**
+                 * the conversion from iterator to const_iterator
+                 */
+                template <typename E>
+                constexpr basic_iterator (const basic_iterator<E>& that,
+                        typename std::enable_if<std::is_const<D>::value && !std::is_const<E>::value>::type* = 0) :
+                        _d(that.container()), _i(that.index()) {}
+
+                constexpr D* container () const {
+                    return _d;}
+
+                constexpr size_type index () const {
+                    return _i;}
+
+                friend constexpr bool operator == (const basic_iterator& lhs, const basic_iterator& rhs) {
+                    return (lhs._d == rhs._d) && (lhs._i == rhs._i);}
+
+                friend constexpr bool operator != (const basic_iterator& lhs, const basic_iterator& rhs) {
+                    return !(lhs == rhs);}
+
+                friend constexpr bool operator < (const basic_iterator& lhs, const basic_iterator& rhs) {
+                    return lhs._i < rhs._i;}
+
+                friend constexpr bool operator > (const basic_iterator& lhs, const basic_iterator& rhs) {
+                    return rhs < lhs;}
+
+                friend constexpr bool operator <= (const basic_iterator& lhs, const basic_iterator& rhs) {
+                    return !(rhs < lhs);}
+
+                friend constexpr bool operator >= (const basic_iterator& lhs, const basic_iterator& rhs) {
+                    return !(lhs < rhs);}
+
+                friend constexpr basic_iterator operator + (basic_iterator lhs, difference_type d) {
+                    return basic_iterator(lhs._d, lhs._i + d);}
+
+                friend constexpr basic_iterator operator + (difference_type d, basic_iterator rhs) {
+                    return rhs + d;}
+
+                friend constexpr basic_iterator operator - (basic_iterator lhs, difference_type d) {
+                    return basic_iterator(lhs._d, lhs._i - d);}
+
+                friend constexpr difference_type operator - (const basic_iterator& lhs, const basic_iterator& rhs) {
+                    return difference_type(lhs._i) - difference_type(rhs._i);}
+
+                constexpr reference operator * () const {
+                    return (*_d)[_i];}
+
+                constexpr pointer operator -> () const {
+                    return &**this;}
+
+                constexpr reference operator [] (difference_type d) const {
+                    return (*_d)[_i + d];}
+
+                STATIC_DEQUE_CONSTEXPR14 basic_iterator& operator ++ () {
+                    ++_i;
+                    return *this;}
+
+                STATIC_DEQUE_CONSTEXPR14 basic_iterator operator ++ (int) {
+                    basic_iterator x = *this;
+                    ++_i;
+                    return x;}
+
+                STATIC_DEQUE_CONSTEXPR14 basic_iterator& operator -- () {
+                    --_i;
+                    return *this;}
+
+                STATIC_DEQUE_CONSTEXPR14 basic_iterator operator -- (int) {
+                    basic_iterator x = *this;
+                    --_i;
+                    return x;}
+
+                STATIC_DEQUE_CONSTEXPR14 basic_iterator& operator += (difference_type d) {
+                    _i += d;
+                    return *this;}
+
+                STATIC_DEQUE_CONSTEXPR14 basic_iterator& operator -= (difference_type d) {
+                    _i -= d;
+                    return *this;}};
+
+        typedef basic_iterator<static_deque>       iterator;
+        typedef basic_iterator<const static_deque> const_iterator;
+
+        // ------------
+        // constructors
+        // ------------
+
+        /**
+         * constructs an empty deque
+         */
+        constexpr static_deque () {}
+
+        /**
+         * @param s - number of elements, at most N
+         * @param v - value to fill with
+         */
+        STATIC_DEQUE_CONSTEXPR14 explicit static_deque (size_type s, const_reference v = value_type()) {
+            while (s-- && push_back(v)) {}}
+
+        /**
+         * @param l - values, at most N of them
+         */
+        STATIC_DEQUE_CONSTEXPR14 static_deque (std::initializer_list<value_type> l) {
+            for (const value_type* p = l.begin(); (p != l.end()) && push_back(*p); ++p) {}}
+
+        // -----------
+        // operator []
+        // -----------
+
+        /**
+         * @param i - index relative to the front, less than size()
+         * @return reference to element i, unchecked
+         */
+        STATIC_DEQUE_CONSTEXPR14 reference operator [] (size_type i) {
+            return *slot(physical(i));}
+
+        constexpr const_reference operator [] (size_type i) const {
+            return *slot(physical(i));}
+
+        // --
+        // at
+        // --
+
+        /**
+         * @param i - index relative to the front
+         * @return reference to element i
+         * @throws out_of_range when i is not less than size()
+         */
+        STATIC_DEQUE_CONSTEXPR14 reference at (size_type i) {
+            if (i >= _size)
+                throw std::out_of_range("static_deque::at index out of range");
+            return (*this)[i];}
+
+        constexpr const_reference at (size_type i) const {
+            return (i < _size) ? (*this)[i] : throw std::out_of_range("static_deque::at index out of range");}
+
+        // ----
+        // back
+        // ----
+
+        STATIC_DEQUE_CONSTEXPR14 reference back () {
+            assert(!empty());
+            return (*this)[_size - 1];}
+
+        constexpr const_reference back () const {
+            return (*this)[_size - 1];}
+
+        // -----
+        // begin
+        // -----
+
+        STATIC_DEQUE_CONSTEXPR14 iterator begin () {
+            return iterator(this, 0);}
+
+        constexpr const_iterator begin () const {
+            return const_iterator(this, 0);}
+
+        // --------
+        // capacity
+        // --------
+
+        static constexpr size_type capacity () {
+            return N;}
+
+        // -----
+        // clear
+        // -----
+
+        STATIC_DEQUE_CONSTEXPR14 void clear () {
+            while (_size)
+                pop_back();
+            _head = 0;}
+
+        // ------------
+        // emplace_back
+        // ------------
+
+        /**
+         * @param args - constructor arguments for the new element
+         * @return whether the element was added, see the overflow policy
+         */
+        template <typename... Args>
+        STATIC_DEQUE_CONSTEXPR14 bool emplace_back (Args&&... args) {
+            if (full())
+                return O::overflow();
+            construct(physical(_size), std::forward<Args>(args)...);
+            ++_size;
+            assert(valid());
+            return true;}
+
+        // -------------
+        // emplace_front
+        // -------------
+
+        /**
+         * @param args - constructor arguments for the new element
+         * @return whether the element was added, see the overflow policy
+         */
+        template <typename... Args>
+        STATIC_DEQUE_CONSTEXPR14 bool emplace_front (Args&&... args) {
+            if (full())
+                return O::overflow();
+            const size_type h = (_head == 0) ? (N - 1) : (_head - 1);
+            construct(h, std::forward<Args>(args)...);
+            _head = h;
+            ++_size;
+            assert(valid());
+            return true;}
+
+        // -----
+        // empty
+        // -----
+
+        constexpr bool empty () const {
+            return _size == 0;}
+
+        // ---
+        // end
+        // ---
+
+        STATIC_DEQUE_CONSTEXPR14 iterator end () {
+            return iterator(this, _size);}
+
+        constexpr const_iterator end () const {
+            return const_iterator(this, _size);}
+
+        // -----
+        // front
+        // -----
+
+        STATIC_DEQUE_CONSTEXPR14 reference front () {
+            assert(!empty());
+            return (*this)[0];}
+
+        constexpr const_reference front () const {
+            return (*this)[0];}
+
+        // ----
+        // full
+        // ----
+
+        constexpr bool full () const {
+            return _size == N;}
+
+        // --------
+        // max_size
+        // --------
+
+        static constexpr size_type max_size () {
+            return N;}
+
+        // --------
+        // pop_back
+        // --------
+
+        STATIC_DEQUE_CONSTEXPR14 void pop_back () {
+            assert(!empty());
+            --_size;
+            destroy(physical(_size));}
+
+        // ---------
+        // pop_front
+        // ---------
+
+        STATIC_DEQUE_CONSTEXPR14 void pop_front () {
+            assert(!empty());
+            destroy(_head);
+            _head = (_head + 1 == N) ? 0 : (_head + 1);
+            --_size;}
+
+        // ---------
+        // push_back
+        // ---------
+
+        /**
+         * @param v - value to append
+         * @return whether it was appended, see the overflow policy
+         */
+        STATIC_DEQUE_CONSTEXPR14 bool push_back (const_reference v) {
+            return emplace_back(v);}
+
+        STATIC_DEQUE_CONSTEXPR14 bool push_back (value_type&& v) {
+            return emplace_back(std::move(v));}
+
+        // ----------
+        // push_front
+        // ----------
+
+        /**
+         * @param v - value to prepend
+         * @return whether it was prepended, see the overflow policy
+         */
+        STATIC_DEQUE_CONSTEXPR14 bool push_front (const_reference v) {
+            return emplace_front(v);}
+
+        STATIC_DEQUE_CONSTEXPR14 bool push_front (value_type&& v) {
+            return emplace_front(std::move(v));}
+
+        // ----
+        // size
+        // ----
+
+        constexpr size_type size () const {
+            return _size;}};
+
+// -----------
+// operator ==
+// -----------
+
+template <typename T, std::size_t N, typename O>
+STATIC_DEQUE_CONSTEXPR14 bool operator == (const static_deque<T, N, O>& lhs, const static_deque<T, N, O>& rhs) {
+    if (lhs.size() != rhs.size())
+        return false;
+    for (std::size_t i = 0; i != lhs.size(); ++i)
+        if (!(lhs[i] == rhs[i]))
+            return false;
+    return true;}
+
+#endif // StaticDeque_h
@@ -37,16 +37,33 @@ To obtain coverage of the test:
 // includes
 // --------
 
-#include <algorithm> // equal
+#include <algorithm> // equal, sort
+#include <atomic>    // atomic
+#include <cmath>     // nan
+#include <cstdio>    // remove
 #include <cstring>   // strcmp
 #include <deque>     // deque
+#include <iterator>  // istream_iterator, random_access_iterator
+#include <numeric>   // accumulate
 #include <sstream>   // ostringstream
-#include <stdexcept> // invalid_argument
+#include <stdexcept> // invalid_argument, runtime_error
 #include <string>    // ==
+#include <thread>    // thread
+#include <vector>    // vector
+
+#if __cplusplus >= 202002L
+#include <ranges>    // random_access_range
+#endif
 
 #include "gtest/gtest.h"
 
 #include "Deque.h"
+#include "MappedDeque.h"
+#include "MemoryResource.h"
+#include "RingDeque.h"
+#include "SpscDeque.h"
+#include "StaticDeque.h"
+#include "WorkStealingDeque.h"
 
     using namespace std;
 
@@ -74,7 +91,8 @@ typedef testing::Types<
             std::deque<int>,
             std::deque<double>,
             my_deque<int>,
-            my_deque<double> >
+            my_deque<double>,
+            my_deque<int, std::allocator<int>, block_elements<4> > >
         my_types;
 
 TYPED_TEST_CASE(TestDeque, my_types);
@@ -150,6 +168,36 @@ TYPED_TEST(TestDeque, constructor_3){
     ASSERT_EQ(1188, s); 
 }
 
+TYPED_TEST(TestDeque, range_constructor_1){
+    typedef typename TestFixture::deque_type      deque_type;
+
+    std::vector<int> v;
+    for(int i = 0; i < 1234; ++i)
+        v.push_back(i);
+    deque_type x(v.begin(), v.end());
+    ASSERT_EQ(1234, x.size());
+    ASSERT_TRUE(std::equal(v.begin(), v.end(), x.begin()));
+}
+
+TYPED_TEST(TestDeque, range_constructor_2){
+    typedef typename TestFixture::deque_type      deque_type;
+
+    std::istringstream in("1 2 3 4 5 6 7 8 9 10 11 12");
+    deque_type x((std::istream_iterator<int>(in)), std::istream_iterator<int>());
+    ASSERT_EQ(12, x.size());
+    ASSERT_EQ(1,  x.front());
+    ASSERT_EQ(12, x.back());
+}
+
+TYPED_TEST(TestDeque, list_constructor_1){
+    typedef typename TestFixture::deque_type      deque_type;
+
+    deque_type x = {5, 4, 3, 2, 1};
+    ASSERT_EQ(5, x.size());
+    ASSERT_EQ(5, x[0]);
+    ASSERT_EQ(1, x[4]);
+}
+
 TYPED_TEST(TestDeque, copy_constructor){
     typedef typename TestFixture::deque_type      deque_type;
     typedef typename TestFixture::size_type       size_type;
@@ -446,6 +494,26 @@ TYPED_TEST(TestDeque, insert_3){
 }
 
 
+TYPED_TEST(TestDeque, insert_4){
+    typedef typename TestFixture::deque_type      deque_type;
+
+    deque_type x;
+    std::vector<int> y;
+    for(int i = 0; i < 200; ++i){
+        x.push_back(i);
+        y.push_back(i);
+    }
+    for(int i = 0; i < 200; ++i){
+        const int k = (i * 37) % (int)y.size();
+        auto it = x.insert(x.begin() + k, -i);
+        y.insert(y.begin() + k, -i);
+        ASSERT_EQ(k, it - x.begin());
+        ASSERT_EQ(-i, *it);
+    }
+    ASSERT_EQ(400, x.size());
+    ASSERT_TRUE(std::equal(y.begin(), y.end(), x.begin()));
+}
+
 TYPED_TEST(TestDeque, erase_1){
     typedef typename TestFixture::deque_type      deque_type;
     typedef typename TestFixture::size_type       size_type;
@@ -549,6 +617,121 @@ TYPED_TEST(TestDeque, erase_3){
 }
 
 
+TYPED_TEST(TestDeque, erase_4){
+    typedef typename TestFixture::deque_type      deque_type;
+
+    deque_type x;
+    std::vector<int> y;
+    for(int i = 0; i < 400; ++i){
+        x.push_front(i);
+        y.insert(y.begin(), i);
+    }
+    for(int i = 0; i < 390; ++i){
+        const int k = (i * 53) % (int)y.size();
+        auto it = x.erase(x.begin() + k);
+        y.erase(y.begin() + k);
+        ASSERT_EQ(k, it - x.begin());
+        if(k != (int)y.size()){
+            ASSERT_EQ(y[k], *it);
+        }
+    }
+    ASSERT_EQ(10, x.size());
+    ASSERT_TRUE(std::equal(y.begin(), y.end(), x.begin()));
+}
+
+TYPED_TEST(TestDeque, insert_erase_1){
+    typedef typename TestFixture::deque_type      deque_type;
+
+    deque_type x(3, 1);
+    x.insert(x.end(), 9);
+    x.insert(x.begin(), 8);
+    x.insert(x.begin() + 3, x[0]);
+    ASSERT_EQ(6, x.size());
+    ASSERT_EQ(8, x[0]);
+    ASSERT_EQ(8, x[3]);
+    ASSERT_EQ(9, x[5]);
+    x.erase(x.end() - 1);
+    x.erase(x.begin());
+    ASSERT_EQ(4, x.size());
+    ASSERT_EQ(8, x[2]);
+    ASSERT_EQ(1, x.back());
+}
+
+TYPED_TEST(TestDeque, assign_1){
+    typedef typename TestFixture::deque_type      deque_type;
+
+    deque_type x(50, 1);
+    std::vector<int> v(500, 7);
+    x.assign(v.begin(), v.end());
+    ASSERT_EQ(500, x.size());
+    ASSERT_EQ(7, x[499]);
+    x.assign(3, 2);
+    ASSERT_EQ(3, x.size());
+    ASSERT_EQ(2, x.back());
+    x.assign({9, 8});
+    ASSERT_EQ(2, x.size());
+    ASSERT_EQ(8, x.back());
+}
+
+TYPED_TEST(TestDeque, insert_range_1){
+    typedef typename TestFixture::deque_type      deque_type;
+
+    deque_type x;
+    std::vector<int> y;
+    for(int i = 0; i < 100; ++i){
+        x.push_back(i);
+        y.push_back(i);
+    }
+    std::vector<int> v;
+    for(int i = 0; i < 75; ++i)
+        v.push_back(-i);
+    const int at[] = {0, 10, 50, 90, 100, 175};
+    for(int k : at){
+        auto it = x.insert(x.begin() + k, v.begin(), v.end());
+        y.insert(y.begin() + k, v.begin(), v.end());
+        ASSERT_EQ(k, it - x.begin());
+    }
+    ASSERT_EQ(y.size(), x.size());
+    ASSERT_TRUE(std::equal(y.begin(), y.end(), x.begin()));
+}
+
+TYPED_TEST(TestDeque, insert_fill_1){
+    typedef typename TestFixture::deque_type      deque_type;
+
+    deque_type x(40, 1);
+    auto it = x.insert(x.begin() + 5, 30, 2);
+    ASSERT_EQ(5, it - x.begin());
+    it = x.insert(x.end() - 5, 25, 3);
+    ASSERT_EQ(65, it - x.begin());
+    ASSERT_EQ(95, x.size());
+    ASSERT_EQ(40, std::count(x.begin(), x.end(), 1));
+    ASSERT_EQ(30, std::count(x.begin(), x.begin() + 35, 2));
+    ASSERT_EQ(25, std::count(x.begin() + 65, x.begin() + 90, 3));
+}
+
+TYPED_TEST(TestDeque, erase_range_1){
+    typedef typename TestFixture::deque_type      deque_type;
+
+    deque_type x;
+    std::vector<int> y;
+    for(int i = 0; i < 300; ++i){
+        x.push_back(i);
+        y.push_back(i);
+    }
+    auto it = x.erase(x.begin() + 10, x.begin() + 60);
+    y.erase(y.begin() + 10, y.begin() + 60);
+    ASSERT_EQ(10, it - x.begin());
+    it = x.erase(x.begin() + 200, x.begin() + 240);
+    y.erase(y.begin() + 200, y.begin() + 240);
+    ASSERT_EQ(200, it - x.begin());
+    it = x.erase(x.begin(), x.begin());
+    ASSERT_TRUE(it == x.begin());
+    ASSERT_EQ(y.size(), x.size());
+    ASSERT_TRUE(std::equal(y.begin(), y.end(), x.begin()));
+    x.erase(x.begin(), x.end());
+    ASSERT_TRUE(x.empty());
+}
+
 TYPED_TEST(TestDeque, begin_1){
     typedef typename TestFixture::deque_type      deque_type;
     typedef typename TestFixture::size_type       size_type;
@@ -974,6 +1157,78 @@ TYPED_TEST(TestDeque, iterator_minus_equal_3){
 }
 
 
+TYPED_TEST(TestDeque, iterator_difference_1){
+    typedef typename TestFixture::deque_type      deque_type;
+    typedef typename TestFixture::difference_type difference_type;
+    deque_type x(1000, 2);
+
+    auto b = x.begin();
+    auto e = x.end();
+    ASSERT_EQ(1000, e - b);
+    ASSERT_EQ(-1000, b - e);
+    ASSERT_EQ(1000, std::distance(b, e));
+    for(difference_type i = 0; i < 1000; i += 37)
+        ASSERT_EQ(i, (b + i) - b);
+    ASSERT_TRUE(b < e);
+    ASSERT_TRUE(e > b);
+    ASSERT_TRUE(b + 500 <= e - 500);
+    ASSERT_TRUE(b + 501 >= e - 500);
+}
+
+TYPED_TEST(TestDeque, iterator_subscript_1){
+    typedef typename TestFixture::deque_type      deque_type;
+    deque_type x;
+
+    for(int i = 0; i < 100; ++i)
+        x.push_front(i);
+    auto b = x.begin();
+    auto e = x.end();
+    ASSERT_EQ(99, b[0]);
+    ASSERT_EQ(0,  b[99]);
+    ASSERT_EQ(49, b[50]);
+    ASSERT_EQ(0,  e[-1]);
+    ASSERT_EQ(63, *(e - 64));
+    ASSERT_EQ(64, *(35 + b));
+}
+
+TYPED_TEST(TestDeque, iterator_algorithms_1){
+    typedef typename TestFixture::deque_type      deque_type;
+    deque_type x;
+
+    for(int i = 0; i < 300; ++i){
+        x.push_back((i * 7919) % 300);
+        x.push_front((i * 104729) % 300 + 300);
+    }
+    std::sort(x.begin(), x.end());
+    for(int i = 0; i < 600; ++i)
+        ASSERT_EQ(i, x[i]);
+    const deque_type y(x);
+    auto p = std::lower_bound(y.begin(), y.end(), 421);
+    ASSERT_EQ(421, p - y.begin());
+    ASSERT_EQ(421, *p);
+}
+
+TYPED_TEST(TestDeque, iterator_default_1){
+    typedef typename TestFixture::deque_type      deque_type;
+    typedef typename deque_type::iterator         iterator;
+    typedef typename deque_type::const_iterator   const_iterator;
+    iterator b = iterator();
+    const_iterator c = const_iterator();
+    ASSERT_TRUE(b == iterator());
+    ASSERT_TRUE(c == const_iterator());
+    deque_type x(10, 3);
+    b = x.begin() + 2;
+    c = b;
+    ASSERT_EQ(3, *c);
+#if __cplusplus >= 202002L
+    static_assert(std::random_access_iterator<iterator>);
+    static_assert(std::random_access_iterator<const_iterator>);
+    static_assert(std::ranges::random_access_range<deque_type>);
+    std::ranges::fill(x, 4);
+    ASSERT_EQ(4, *std::ranges::min_element(x));
+#endif
+}
+
 TYPED_TEST(TestDeque, const_begin_1){
     typedef typename TestFixture::deque_type      deque_type;
     typedef typename TestFixture::size_type       size_type;
@@ -1198,6 +1453,35 @@ TYPED_TEST(TestDeque, resize3){
     ASSERT_EQ(15, s2);
 }
 
+TYPED_TEST(TestDeque, resize4){
+    typedef typename TestFixture::deque_type      deque_type;
+
+    deque_type x(5, 1);
+    x.resize(2000000, 2);
+    ASSERT_EQ(2000000, x.size());
+    ASSERT_EQ(1, x[4]);
+    ASSERT_EQ(2, x[5]);
+    ASSERT_EQ(2, x.back());
+    x.resize(3);
+    ASSERT_EQ(3, x.size());
+    ASSERT_EQ(1, x.back());
+}
+
+TYPED_TEST(TestDeque, resize5){
+    typedef typename TestFixture::deque_type      deque_type;
+
+    deque_type x;
+    for(int i = 0; i < 100; ++i)
+        x.push_front(i);
+    x.resize(0);
+    ASSERT_TRUE(x.empty());
+    x.resize(10);
+    ASSERT_EQ(10, x.size());
+    ASSERT_EQ(0, x[9]);
+    x.push_front(7);
+    ASSERT_EQ(7, x.front());
+}
+
 TYPED_TEST(TestDeque, pop_front){
     typedef typename TestFixture::deque_type      deque_type;
     typedef typename TestFixture::size_type       size_type;
@@ -1304,6 +1588,91 @@ TYPED_TEST(TestDeque, push_front3){
     ASSERT_EQ(1, x[0]);    
 }
 
+TYPED_TEST(TestDeque, push_front4){
+    typedef typename TestFixture::deque_type      deque_type;
+    typedef typename TestFixture::const_pointer   const_pointer;
+
+    deque_type x;
+    x.push_back(7);
+    const_pointer p = &x[0];
+    for(int i = 0; i < 1000; ++i)
+        x.push_front(i);
+    ASSERT_EQ(1001, x.size());
+    ASSERT_EQ(p, &x[1000]);
+    ASSERT_EQ(7, x.back());
+    ASSERT_EQ(999, x.front());
+}
+
+TYPED_TEST(TestDeque, push_back4){
+    typedef typename TestFixture::deque_type      deque_type;
+    typedef typename TestFixture::const_pointer   const_pointer;
+
+    deque_type x;
+    x.push_back(7);
+    const_pointer p = &x[0];
+    for(int i = 0; i < 1000; ++i)
+        x.push_back(i);
+    ASSERT_EQ(1001, x.size());
+    ASSERT_EQ(p, &x[0]);
+    ASSERT_EQ(7, x.front());
+    ASSERT_EQ(999, x.back());
+}
+
+TYPED_TEST(TestDeque, push_pop_fifo){
+    typedef typename TestFixture::deque_type      deque_type;
+
+    deque_type x;
+    for(int i = 0; i < 5000; ++i){
+        x.push_back(i);
+        x.push_back(i);
+        x.pop_front();
+    }
+    ASSERT_EQ(5000, x.size());
+    ASSERT_EQ(2500, x.front());
+    ASSERT_EQ(4999, x.back());
+    for(int i = 0; i < 5000; ++i)
+        x.pop_back();
+    ASSERT_TRUE(x.empty());
+    x.push_front(3);
+    ASSERT_EQ(3, x[0]);
+}
+
+TYPED_TEST(TestDeque, emplace_1){
+    typedef typename TestFixture::deque_type      deque_type;
+
+    deque_type x;
+    x.emplace_back(2);
+    x.emplace_front(1);
+    x.emplace_back(4);
+    auto it = x.emplace(x.begin() + 2, 3);
+    ASSERT_EQ(2, it - x.begin());
+    ASSERT_EQ(4, x.size());
+    for(int i = 0; i < 4; ++i)
+        ASSERT_EQ(i + 1, x[i]);
+}
+
+TYPED_TEST(TestDeque, move_constructor_1){
+    typedef typename TestFixture::deque_type      deque_type;
+
+    deque_type x(300, 4);
+    deque_type y(std::move(x));
+    ASSERT_EQ(300, y.size());
+    ASSERT_EQ(4, y[299]);
+    ASSERT_TRUE(x.empty());
+}
+
+TYPED_TEST(TestDeque, move_assignment_1){
+    typedef typename TestFixture::deque_type      deque_type;
+
+    deque_type x(300, 4);
+    deque_type y(20, 1);
+    y = std::move(x);
+    ASSERT_EQ(300, y.size());
+    ASSERT_EQ(4, y.front());
+    x.push_back(5);
+    ASSERT_EQ(5, x.back());
+}
+
 TYPED_TEST(TestDeque, copy_assignment){
     typedef typename TestFixture::deque_type      deque_type;
     typedef typename TestFixture::size_type       size_type;
@@ -1349,4 +1718,1259 @@ TYPED_TEST(TestDeque, copy_assignment3){
 
     while(it != e)
         ASSERT_EQ(*it++, *b++);    
-} 
\ No newline at end of file
+} 
+
+TYPED_TEST(TestDeque, swap_1){
+    typedef typename TestFixture::deque_type      deque_type;
+
+    deque_type x(300, 1);
+    deque_type y(5, 2);
+    const typename TestFixture::pointer p = &x[100];
+    x.swap(y);
+    ASSERT_EQ(5,   x.size());
+    ASSERT_EQ(300, y.size());
+    ASSERT_EQ(2, x.back());
+    ASSERT_EQ(p, &y[100]);
+}
+
+TYPED_TEST(TestDeque, swap_2){
+    typedef typename TestFixture::deque_type      deque_type;
+
+    deque_type x;
+    deque_type y(1000, 3);
+    using std::swap;
+    swap(x, y);
+    ASSERT_TRUE(y.empty());
+    ASSERT_EQ(1000, x.size());
+    x.push_front(4);
+    y.push_back(5);
+    ASSERT_EQ(4, x.front());
+    ASSERT_EQ(5, y.front());
+    ASSERT_TRUE(noexcept(swap(x, y)));
+}
+
+struct summer {
+    double total;
+
+    summer () : total(0) {}
+
+    void operator () (double v) {
+        total += v;}};
+
+TYPED_TEST(TestDeque, segmented_1){
+    typedef typename TestFixture::deque_type      deque_type;
+
+    deque_type x;
+    for(int i = 0; i < 1000; ++i)
+        x.push_front(i % 10);
+    ASSERT_EQ(100, count(x.begin(), x.end(), 3));
+    ASSERT_EQ(4500, accumulate(x.begin(), x.end(), 0));
+    ASSERT_EQ(4500, for_each(x.begin(), x.end(), summer()).total);
+    ASSERT_EQ(x.begin() + 6, find(x.begin(), x.end(), 3));
+    ASSERT_EQ(x.end(), find(x.begin(), x.end(), 10));
+    ASSERT_EQ(x.begin() + 506, find(x.begin() + 500, x.end() - 1, 3));
+}
+
+TYPED_TEST(TestDeque, segmented_2){
+    typedef typename TestFixture::deque_type      deque_type;
+
+    deque_type x(700, 1);
+    fill(x.begin() + 100, x.begin() + 600, 2);
+    ASSERT_EQ(500, count(x.begin(), x.end(), 2));
+    deque_type y(700, 0);
+    y.push_front(9);
+    ASSERT_EQ(y.begin() + 701, copy(x.begin(), x.end(), y.begin() + 1));
+    ASSERT_EQ(9, y.front());
+    ASSERT_TRUE(std::equal(x.begin(), x.end(), y.begin() + 1));
+    std::vector<int> v(700);
+    copy(x.begin(), x.end(), v.begin());
+    ASSERT_EQ(1200, accumulate(v.begin(), v.end(), 0));
+}
+
+// -----------
+// TestMyDeque
+// -----------
+
+int allocations = 0;
+
+template <typename T>
+struct counting_allocator : std::allocator<T> {
+    template <typename U>
+    struct rebind {
+        typedef counting_allocator<U> other;};
+
+    counting_allocator () {}
+
+    template <typename U>
+    counting_allocator (const counting_allocator<U>&) {}
+
+    T* allocate (std::size_t n) {
+        ++allocations;
+        return std::allocator<T>::allocate(n);}};
+
+TEST(TestMyDeque, append_range_1){
+    my_deque<int> x(3, 1);
+    std::vector<int> v(2000, 2);
+    x.append_range(v.begin(), v.end());
+    ASSERT_EQ(2003, x.size());
+    ASSERT_EQ(1, x[2]);
+    ASSERT_EQ(2, x[3]);
+    ASSERT_EQ(2, x.back());
+}
+
+TEST(TestMyDeque, append_range_2){
+    my_deque<double> x;
+    std::vector<double> v(100, 0.5);
+    x.append_range(v);
+    x.append_range(v);
+    ASSERT_EQ(200, x.size());
+    ASSERT_EQ(0.5, x[199]);
+}
+
+TEST(TestMyDeque, move_1){
+    static_assert(std::is_nothrow_move_constructible<my_deque<std::string>>::value, "");
+    static_assert(std::is_nothrow_move_assignable<my_deque<std::string>>::value, "");
+
+    my_deque<std::string> x;
+    std::string s(100, 'a');
+    x.push_back(std::move(s));
+    x.push_front(std::string(100, 'b'));
+    ASSERT_TRUE(s.empty());
+    my_deque<std::string> y(std::move(x));
+    ASSERT_TRUE(x.empty());
+    ASSERT_EQ(2, y.size());
+    ASSERT_EQ('b', y[0][99]);
+}
+
+TEST(TestMyDeque, emplace_2){
+    my_deque<std::pair<int, std::string> > x;
+    for(int i = 0; i < 50; ++i)
+        x.emplace_back(i, std::string(i, 'x'));
+    auto it = x.emplace(x.begin() + 10, -1, "y");
+    ASSERT_EQ(-1, it->first);
+    ASSERT_EQ(51, x.size());
+    ASSERT_EQ(49, x.back().second.size());
+    x.erase(x.begin() + 5);
+    ASSERT_EQ(std::string("y"), x[9].second);
+}
+
+TEST(TestMyDeque, reserve_1){
+    my_deque<int, counting_allocator<int> > x;
+    x.reserve_back(1000);
+    ASSERT_LE(1000, x.back_capacity());
+    const int before = allocations;
+    for(int i = 0; i < 1000; ++i)
+        x.push_back(i);
+    ASSERT_EQ(before, allocations);
+    ASSERT_EQ(999, x.back());
+}
+
+TEST(TestMyDeque, reserve_2){
+    my_deque<int, counting_allocator<int> > x(10, 1);
+    x.reserve_back(300);
+    x.reserve_front(500);
+    ASSERT_LE(500, x.front_capacity());
+    ASSERT_LE(300, x.back_capacity());
+    const int before = allocations;
+    for(int i = 0; i < 500; ++i)
+        x.push_front(i);
+    for(int i = 0; i < 300; ++i)
+        x.push_back(i);
+    ASSERT_EQ(before, allocations);
+    ASSERT_EQ(810, x.size());
+    ASSERT_EQ(499, x.front());
+}
+
+TEST(TestMyDeque, shrink_to_fit_1){
+    my_deque<int> x;
+    x.reserve_back(5000);
+    x.reserve_front(5000);
+    for(int i = 0; i < 50; ++i)
+        x.push_back(i);
+    x.shrink_to_fit();
+    ASSERT_GT(100, x.back_capacity() + x.front_capacity());
+    ASSERT_EQ(50, x.size());
+    for(int i = 0; i < 50; ++i)
+        ASSERT_EQ(i, x[i]);
+    x.push_front(-1);
+    x.push_back(50);
+    ASSERT_EQ(-1, x.front());
+    ASSERT_EQ(50, x.back());
+    x.clear();
+    x.shrink_to_fit();
+    ASSERT_EQ(0, x.back_capacity());
+}
+
+TEST(TestMyDeque, block_size_1){
+    static_assert(block_bytes<512>::elements<int>::value    == 128, "");
+    static_assert(block_bytes<512>::elements<double>::value == 64,  "");
+    static_assert(block_bytes<512>::elements<char[48]>::value == 8, "");
+    static_assert(block_bytes<16>::elements<char[48]>::value  == 1, "");
+    static_assert(sizeof(my_deque<int>) <= 8 * sizeof(void*), "");
+
+    my_deque<int, std::allocator<int>, block_elements<1> > x;
+    for(int i = 0; i < 100; ++i){
+        x.push_back(i);
+        x.push_front(-i);
+    }
+    ASSERT_EQ(200, x.size());
+    ASSERT_EQ(200, x.end() - x.begin());
+    ASSERT_EQ(-99, x.front());
+    ASSERT_EQ(99, *(x.begin() + 199));
+    x.erase(x.begin() + 50, x.begin() + 150);
+    ASSERT_EQ(50, x[50]);
+}
+
+TEST(TestMyDeque, block_size_2){
+    my_deque<int, std::allocator<int>, block_bytes<64> > x;
+    std::deque<int> y;
+    for(int i = 0; i < 2000; ++i){
+        const int r = (i * 7919) % 11;
+        if(r < 4){
+            x.push_back(i);
+            y.push_back(i);}
+        else if(r < 7){
+            x.push_front(i);
+            y.push_front(i);}
+        else if(r < 9 && !y.empty()){
+            x.pop_front();
+            y.pop_front();}
+        else if(!y.empty()){
+            x.pop_back();
+            y.pop_back();}
+    }
+    ASSERT_EQ(y.size(), x.size());
+    ASSERT_TRUE(std::equal(y.begin(), y.end(), x.begin()));
+}
+
+TEST(TestMyDeque, growth_policy_1){
+    ASSERT_EQ(18, (geometric_growth<>::next_size(8, 9)));
+    ASSERT_EQ(14, (geometric_growth<3, 2>::next_size(8, 9)));
+    ASSERT_EQ(25, (fixed_growth<16>::next_size(8, 9)));
+    ASSERT_EQ(512, (page_growth<4096>::next_size(8, 9)));
+    ASSERT_TRUE((geometric_growth<>::recentre(20, 9)));
+    ASSERT_FALSE((geometric_growth<>::recentre(18, 9)));
+    ASSERT_TRUE((fixed_growth<4>::recentre(13, 9)));
+    ASSERT_FALSE((fixed_growth<4>::recentre(12, 9)));
+}
+
+TEST(TestMyDeque, growth_policy_2){
+    my_deque<int, std::allocator<int>, block_elements<2>, fixed_growth<1> > x;
+    my_deque<int, std::allocator<int>, block_elements<2>, page_growth<64> > y;
+    std::deque<int> z;
+    for(int i = 0; i < 3000; ++i){
+        if(i % 3){
+            x.push_front(i);
+            y.push_front(i);
+            z.push_front(i);}
+        else{
+            x.push_back(i);
+            y.push_back(i);
+            z.push_back(i);}
+        if(i % 7 == 0){
+            x.pop_back();
+            y.pop_back();
+            z.pop_back();}
+    }
+    x.reserve_front(100);
+    y.reserve_back(100);
+    ASSERT_EQ(z.size(), x.size());
+    ASSERT_TRUE(std::equal(z.begin(), z.end(), x.begin()));
+    ASSERT_TRUE(std::equal(z.begin(), z.end(), y.begin()));
+}
+
+TEST(TestMyDeque, recycle_1){
+    my_deque<int, counting_allocator<int> > x;
+    for(int i = 0; i < 1000; ++i)
+        x.push_back(i);
+    for(int i = 0; i < 100000; ++i){
+        x.push_back(i);
+        x.pop_front();
+    }
+    const int before = allocations;
+    for(int i = 0; i < 100000; ++i){
+        x.push_back(i);
+        x.pop_front();
+    }
+    ASSERT_EQ(before, allocations);
+    ASSERT_EQ(1000, x.size());
+    ASSERT_EQ(99999, x.back());
+    ASSERT_EQ(99000, x.front());
+}
+
+TEST(TestMyDeque, recycle_2){
+    my_deque<int> x;
+    x.max_spare_blocks(2);
+    x.resize(10000);
+    x.resize(0);
+    ASSERT_EQ(2, x.spare_blocks());
+    x.max_spare_blocks(0);
+    ASSERT_EQ(0, x.spare_blocks());
+    x.resize(10000);
+    x.erase(x.begin(), x.begin() + 5000);
+    ASSERT_EQ(0, x.spare_blocks());
+    my_deque<int> y(std::move(x));
+    ASSERT_EQ(0, y.max_spare_blocks());
+}
+
+TEST(TestMyDeque, recycle_3){
+    typedef my_deque<int, counting_allocator<int> > deque_type;
+    deque_type::thread_cache_blocks(64);
+    ASSERT_EQ(64, deque_type::thread_cache_blocks());
+    {
+        deque_type x(100000, 1);
+    }
+    const int before = allocations;
+    {
+        deque_type x;
+        x.max_spare_blocks(0);
+        for(int i = 0; i < 5000; ++i)
+            x.push_front(i);
+        x.clear();
+        for(int i = 0; i < 5000; ++i)
+            x.push_back(i);
+    }
+    ASSERT_GT(before + 10, allocations);
+    deque_type::thread_cache_blocks(0);
+    ASSERT_EQ(0, deque_type::thread_cache_blocks());
+}
+
+TEST(TestMyDeque, recycle_5){
+    typedef my_deque<int, counting_allocator<int> > deque_type;
+    deque_type::thread_cache_blocks(64);
+    const int before = allocations;
+    {
+        deque_type x(5000, 1);
+        x.max_spare_blocks(100);
+        x.erase(x.begin(), x.begin() + 4000);
+        ASSERT_LT(20, x.spare_blocks());
+        x.shrink_to_fit();
+        x.clear();
+        x.shrink_to_fit();
+    }
+    {
+        deque_type x(5000, 1);
+    }
+    ASSERT_LT(before + 70, allocations);
+    deque_type::thread_cache_blocks(0);
+}
+
+template <typename T>
+struct arena_allocator {
+    typedef T value_type;
+
+    int* live;
+
+    explicit arena_allocator (int* p) : live(p) {}
+
+    template <typename U>
+    arena_allocator (const arena_allocator<U>& that) : live(that.live) {}
+
+    T* allocate (std::size_t n) {
+        ++*live;
+        return std::allocator<T>().allocate(n);}
+
+    void deallocate (T* p, std::size_t n) {
+        --*live;
+        std::allocator<T>().deallocate(p, n);}
+
+    template <typename U>
+    bool operator == (const arena_allocator<U>& that) const {
+        return live == that.live;}
+
+    template <typename U>
+    bool operator != (const arena_allocator<U>& that) const {
+        return live != that.live;}};
+
+TEST(TestMyDeque, recycle_4){
+    typedef my_deque<int, arena_allocator<int> > deque_type;
+    ASSERT_EQ(0, deque_type::thread_cache_blocks());
+    deque_type::thread_cache_blocks(64);
+    ASSERT_EQ(0, deque_type::thread_cache_blocks());
+    int live = 0;
+    {
+        const arena_allocator<int> a(&live);
+        deque_type x(a);
+        x.max_spare_blocks(0);
+        for(int i = 0; i < 5000; ++i)
+            x.push_back(i);
+        ASSERT_LT(0, live);
+        while (x.size() > 1)
+            x.pop_front();
+        ASSERT_EQ(4999, x.front());
+    }
+    ASSERT_EQ(0, live);
+}
+
+struct counting_resource : memory_resource {
+    int live;
+
+    counting_resource () : live(0) {}
+
+    void* do_allocate (std::size_t bytes, std::size_t alignment) {
+        ++live;
+        return new_delete_resource()->allocate(bytes, alignment);}
+
+    void do_deallocate (void* p, std::size_t bytes, std::size_t alignment) {
+        --live;
+        new_delete_resource()->deallocate(p, bytes, alignment);}
+
+    bool do_is_equal (const memory_resource& that) const noexcept {
+        return this == &that;}};
+
+TEST(TestMyDeque, resource_1){
+    typedef my_deque<int, polymorphic_allocator<int> > deque_type;
+    counting_resource upstream;
+    {
+        monotonic_buffer_resource arena(&upstream);
+        deque_type x(&arena);
+        for(int i = 0; i < 10000; ++i)
+            x.push_back(i);
+        for(int i = 0; i < 10000; ++i)
+            x.push_front(-i);
+        ASSERT_EQ(20000, x.size());
+        ASSERT_EQ(-9999, x.front());
+        ASSERT_EQ(9999, x.back());
+        ASSERT_EQ(&arena, x.get_allocator().resource());
+        ASSERT_LT(0, upstream.live);
+        ASSERT_GT(20, upstream.live);
+    }
+    ASSERT_EQ(0, upstream.live);
+}
+
+TEST(TestMyDeque, resource_2){
+    typedef my_deque<int, polymorphic_allocator<int> > deque_type;
+    monotonic_buffer_resource arena;
+    counting_resource other;
+    deque_type x(100, 7, &arena);
+    deque_type y(x);
+    ASSERT_EQ(get_default_resource(), y.get_allocator().resource());
+    ASSERT_TRUE(x == y);
+    deque_type z(&other);
+    z = x;
+    ASSERT_EQ(&other, z.get_allocator().resource());
+    ASSERT_TRUE(x == z);
+    z = std::move(y);
+    ASSERT_EQ(&other, z.get_allocator().resource());
+    ASSERT_EQ(100, z.size());
+    ASSERT_EQ(7, z.back());
+    z.clear();
+    z.shrink_to_fit();
+    ASSERT_EQ(0, other.live);
+}
+
+TEST(TestMyDeque, resource_3){
+    typedef my_deque<int, polymorphic_allocator<int> > deque_type;
+    char buffer[256];
+    counting_resource upstream;
+    monotonic_buffer_resource arena(buffer, sizeof(buffer), &upstream);
+    {
+        deque_type x(&arena);
+        deque_type y(x.get_allocator());
+        for(int i = 0; i < 1000; ++i)
+            y.push_back(i);
+        x.swap(y);
+        ASSERT_EQ(1000, x.size());
+        ASSERT_EQ(0, y.size());
+        x = std::move(y);
+        ASSERT_TRUE(x.empty());
+    }
+    ASSERT_LT(0, upstream.live);
+    arena.release();
+    ASSERT_EQ(0, upstream.live);
+}
+
+int constructions = 0;
+
+template <typename T>
+struct constructing_allocator : std::allocator<T> {
+    template <typename U>
+    struct rebind {
+        typedef constructing_allocator<U> other;};
+
+    constructing_allocator () {}
+
+    template <typename U>
+    constructing_allocator (const constructing_allocator<U>&) {}
+
+    template <typename U, typename... Args>
+    void construct (U* p, Args&&... args) {
+        ++constructions;
+        ::new (static_cast<void*>(p)) U(std::forward<Args>(args)...);}};
+
+TEST(TestMyDeque, trivial_1){
+    ASSERT_TRUE((trivial_construct<std::allocator<int>, int>::value));
+    ASSERT_TRUE((trivial_construct<counting_allocator<double>, double>::value));
+    ASSERT_TRUE((trivial_construct<polymorphic_allocator<int>, int>::value));
+    ASSERT_FALSE((trivial_construct<constructing_allocator<int>, int>::value));
+    ASSERT_FALSE((trivial_construct<std::allocator<std::string>, std::string>::value));
+    ASSERT_TRUE((trivial_destroy<std::allocator<int>, int>::value));
+    ASSERT_FALSE((trivial_destroy<std::allocator<std::string>, std::string>::value));
+}
+
+TEST(TestMyDeque, trivial_2){
+    my_deque<int> x;
+    for(int i = 0; i < 1000; ++i)
+        x.push_front(i);
+    my_deque<int> y(x);
+    ASSERT_TRUE(x == y);
+    y.insert(y.begin() + 3, x.begin(), x.end());
+    ASSERT_EQ(2000, y.size());
+    ASSERT_EQ(999, y[3]);
+    ASSERT_EQ(996, y[1003]);
+    my_deque<int> z(std::move(y), std::allocator<int>());
+    z = x;
+    ASSERT_TRUE(x == z);
+}
+
+TEST(TestMyDeque, trivial_3){
+    constructions = 0;
+    my_deque<int, constructing_allocator<int> > x(100, 1);
+    my_deque<int, constructing_allocator<int> > y(x);
+    ASSERT_EQ(200, constructions);
+    my_deque<std::string> s(300, "abc");
+    my_deque<std::string> t(s);
+    t.push_front("x");
+    ASSERT_EQ("abc", t.back());
+    ASSERT_EQ(301, t.size());
+}
+
+struct fixed_point {
+    const int x;};
+
+TEST(TestMyDeque, trivial_4){
+    const fixed_point p = {7};
+    my_deque<fixed_point> x(300, p);
+    my_deque<fixed_point> y(x);
+    y.push_front(fixed_point{1});
+    y.resize(400, p);
+    ASSERT_EQ(400, y.size());
+    ASSERT_EQ(1, y.front().x);
+    ASSERT_EQ(7, y[1].x);
+    ASSERT_EQ(7, y.back().x);
+}
+
+TEST(TestMyDeque, swap_3){
+    typedef my_deque<int, polymorphic_allocator<int> > deque_type;
+    counting_resource r;
+    {
+        deque_type x(1000, 1, &r);
+        deque_type y(10, 2, &r);
+        swap(x, y);
+        ASSERT_EQ(&r, x.get_allocator().resource());
+        ASSERT_EQ(&r, y.get_allocator().resource());
+        ASSERT_EQ(10, x.size());
+        ASSERT_EQ(1000, y.size());
+        y.push_back(3);
+        x.push_front(4);
+        ASSERT_EQ(3, y.back());
+        ASSERT_EQ(4, x.front());
+    }
+    ASSERT_EQ(0, r.live);
+}
+
+template <typename T>
+struct swapping_allocator : arena_allocator<T> {
+    typedef std::true_type propagate_on_container_swap;
+
+    template <typename U>
+    struct rebind {
+        typedef swapping_allocator<U> other;};
+
+    explicit swapping_allocator (int* p) : arena_allocator<T>(p) {}
+
+    template <typename U>
+    swapping_allocator (const swapping_allocator<U>& that) : arena_allocator<T>(that) {}};
+
+TEST(TestMyDeque, swap_4){
+    typedef my_deque<int, swapping_allocator<int> > deque_type;
+    int r = 0;
+    int t = 0;
+    {
+        const swapping_allocator<int> a(&r);
+        const swapping_allocator<int> b(&t);
+        deque_type x(1000, 1, a);
+        deque_type y(10, 2, b);
+        swap(x, y);
+        ASSERT_EQ(&t, x.get_allocator().live);
+        ASSERT_EQ(&r, y.get_allocator().live);
+        ASSERT_EQ(1000, y.size());
+        y.push_back(3);
+        x.push_front(4);
+        ASSERT_EQ(3, y.back());
+        ASSERT_EQ(4, x.front());
+    }
+    ASSERT_EQ(0, r);
+    ASSERT_EQ(0, t);
+}
+
+TEST(TestMyDeque, segments_1){
+    typedef my_deque<int, std::allocator<int>, block_elements<8> > deque_type;
+    typedef deque_type::segment_view<deque_type::iterator> view_type;
+    deque_type x;
+    for(int i = 0; i < 20; ++i)
+        x.push_back(i);
+    x.push_front(-1);
+    std::vector<std::size_t> sizes;
+    int expected = -1;
+    view_type v = x.segments();
+    for(view_type::iterator s = v.begin(); s != v.end(); ++s) {
+        sizes.push_back(s->size());
+        for(int* p = s->begin(); p != s->end(); ++p)
+            ASSERT_EQ(expected++, *p);}
+    ASSERT_EQ(20, expected);
+    ASSERT_EQ(4, sizes.size());
+    ASSERT_EQ(1, sizes[0]);
+    ASSERT_EQ(8, sizes[1]);
+}
+
+TEST(TestMyDeque, segments_2){
+    typedef my_deque<double>::segment_view<my_deque<double>::const_iterator> view_type;
+    const my_deque<double> x;
+    ASSERT_TRUE(x.segments().begin() == x.segments().end());
+    const my_deque<double> y(1000, 0.5);
+    view_type v = my_deque<double>::segments(y.begin() + 10, y.end() - 10);
+    double total = 0;
+    std::size_t n = 0;
+    for(view_type::iterator s = v.begin(); s != v.end(); ++s) {
+        total = std::accumulate(s->begin(), s->end(), total);
+        n += s->size();}
+    ASSERT_EQ(980, n);
+    ASSERT_EQ(490, total);
+}
+
+TEST(TestMyDeque, block_mismatch_1){
+    std::vector<int>    a(300);
+    std::vector<double> b(300);
+    std::vector<char>   c(300);
+    for(int i = 0; i < 300; ++i) {
+        a[i] = i;
+        b[i] = i * 0.5;
+        c[i] = static_cast<char>(i);}
+    for(std::size_t n = 0; n < 70; ++n)
+        for(std::size_t d = 0; d <= n; ++d) {
+            std::vector<int>    x(a.begin(), a.begin() + n);
+            std::vector<double> y(b.begin(), b.begin() + n);
+            std::vector<char>   z(c.begin(), c.begin() + n);
+            if (d < n) {
+                ++x[d];
+                y[d] = -1;
+                ++z[d];}
+            ASSERT_EQ(d, block_mismatch(a.data(), x.data(), n));
+            ASSERT_EQ(d, block_mismatch(b.data(), y.data(), n));
+            ASSERT_EQ(d, block_mismatch(c.data(), z.data(), n));}
+}
+
+TEST(TestMyDeque, block_mismatch_2){
+    my_deque<int> x;
+    my_deque<int, std::allocator<int>, block_elements<4> > u;
+    for(int i = 0; i < 3000; ++i)
+        x.push_back(i);
+    my_deque<int> y;
+    for(int i = 2999; i >= 0; --i)
+        y.push_front(i);
+    y.push_front(-1);
+    y.pop_front();
+    ASSERT_TRUE(x == y);
+    for(int i = 0; i < 3000; i += 377) {
+        ++y[i];
+        ASSERT_FALSE(x == y);
+        ASSERT_TRUE(x < y);
+        ASSERT_FALSE(y < x);
+        --y[i];}
+    y.push_back(0);
+    ASSERT_TRUE(x < y);
+    ASSERT_FALSE(x == y);
+}
+
+TEST(TestMyDeque, block_mismatch_3){
+    const double nan = std::nan("");
+    my_deque<double> x(1000, 1.0);
+    my_deque<double> y(1000, 1.0);
+    x[10] = 0.0;
+    y[10] = -0.0;
+    ASSERT_TRUE(x == y);
+    x[500] = nan;
+    y[500] = nan;
+    ASSERT_FALSE(x == y);
+    ASSERT_FALSE(x < y);
+    y[700] = 2.0;
+    ASSERT_TRUE(x < y);
+    ASSERT_FALSE(y < x);
+}
+
+TEST(TestMyDeque, stats_0){
+    my_deque<int> x(100, 1);
+    x.push_front(0);
+    ASSERT_EQ(0, x.stats().copies);
+    ASSERT_EQ(0, x.stats().front_ops);
+    ASSERT_EQ(0, x.stats().bytes_reserved);
+}
+
+TEST(TestMyDeque, memory_usage_1){
+    my_deque<int> x;
+    ASSERT_EQ(0, x.memory_usage().total_bytes());
+    x.push_back(1);
+    deque_memory m = x.memory_usage();
+    ASSERT_EQ(sizeof(int), m.element_bytes);
+    ASSERT_EQ(1, m.blocks);
+    ASSERT_EQ(1, m.partial_blocks);
+    ASSERT_EQ(128 * sizeof(int), m.element_bytes + m.front_unused_bytes + m.back_unused_bytes);
+    ASSERT_LT(0, m.map_bytes);
+    ASSERT_EQ(0, m.spare_bytes);
+}
+
+TEST(TestMyDeque, memory_usage_2){
+    my_deque<int> x;
+    for(int i = 0; i < 256; ++i)
+        x.push_back(i);
+    deque_memory m = x.memory_usage();
+    ASSERT_EQ(3, m.blocks);
+    ASSERT_EQ(0, m.partial_blocks);
+    ASSERT_EQ(0, m.front_unused_bytes);
+    ASSERT_EQ(128 * sizeof(int), m.back_unused_bytes);
+    x.push_front(-1);
+    m = x.memory_usage();
+    ASSERT_EQ(4, m.blocks);
+    ASSERT_EQ(1, m.partial_blocks);
+    ASSERT_EQ(127 * sizeof(int), m.front_unused_bytes);
+    x.reserve_back(1000);
+    m = x.memory_usage();
+    ASSERT_LE(1000 * sizeof(int), m.back_unused_bytes);
+}
+
+TEST(TestMyDeque, memory_usage_3){
+    my_deque<double> x(1000, 2.0);
+    x.erase(x.begin(), x.begin() + 300);
+    deque_memory m = x.memory_usage();
+    ASSERT_EQ(700 * sizeof(double), m.element_bytes);
+    ASSERT_LT(0, m.spare_bytes);
+    ASSERT_EQ(2, m.partial_blocks);
+    x.shrink_to_fit();
+    m = x.memory_usage();
+    ASSERT_EQ(0, m.spare_bytes);
+    ASSERT_EQ(44 * sizeof(double), m.front_unused_bytes);
+    ASSERT_EQ(24 * sizeof(double), m.back_unused_bytes);
+}
+
+TEST(TestMyDeque, write_to_1){
+    my_deque<int> x;
+    for(int i = 0; i < 1000; ++i)
+        x.push_front(i);
+    std::stringstream s;
+    x.write_to(s);
+    x.write_to(s);
+    ASSERT_EQ(2 * (sizeof(deque_stream_header) + 4000), s.str().size());
+    my_deque<int> y(3, 7);
+    ASSERT_TRUE(y.read_from(s));
+    ASSERT_EQ(1003, y.size());
+    ASSERT_TRUE(std::equal(x.begin(), x.end(), y.begin() + 3));
+    my_deque<int> z;
+    ASSERT_TRUE(z.read_from(s));
+    ASSERT_TRUE(x == z);
+    ASSERT_FALSE(z.read_from(s));
+    ASSERT_EQ(1000, z.size());
+}
+
+TEST(TestMyDeque, write_to_2){
+    my_deque<double> x(10, 1.5);
+    std::stringstream s;
+    x.write_to(s);
+    my_deque<int> y;
+    ASSERT_FALSE(y.read_from(s));
+    ASSERT_TRUE(y.empty());
+    std::stringstream t(s.str().substr(0, sizeof(deque_stream_header) + 4 * sizeof(double) + 3));
+    my_deque<double> z;
+    ASSERT_FALSE(z.read_from(t));
+    ASSERT_EQ(4, z.size());
+    ASSERT_EQ(1.5, z.back());
+}
+
+TEST(TestMyDeque, write_to_3){
+    int fd[2];
+    ASSERT_EQ(0, ::pipe(fd));
+    my_deque<int> x;
+    for(int i = 0; i < 100000; ++i)
+        x.push_back(i);
+    x.pop_front();
+    std::thread w([&] () {
+        x.write_to(fd[1]);
+        ::close(fd[1]);});
+    my_deque<int> y(1, -1);
+    y.read_from(fd[0]);
+    w.join();
+    ASSERT_EQ(100000, y.size());
+    ASSERT_TRUE(std::equal(x.begin(), x.end(), y.begin() + 1));
+    ASSERT_THROW(y.read_from(fd[0]), std::runtime_error);
+    ::close(fd[0]);
+}
+
+TEST(TestMyDeque, write_to_5){
+    int fd[2];
+    ASSERT_EQ(0, ::pipe(fd));
+    my_deque<int> x;
+    for(int i = 0; i < 300000; ++i)     // more blocks than IOV_MAX
+        x.push_front(i);
+    std::thread w([&] () {
+        x.write_to(fd[1]);
+        ::close(fd[1]);});
+    my_deque<int> y;
+    y.read_from(fd[0]);
+    w.join();
+    ASSERT_TRUE(x == y);
+    ::close(fd[0]);
+}
+
+TEST(TestMyDeque, write_to_4){
+    int fd[2];
+    ASSERT_EQ(0, ::pipe(fd));
+    my_deque<int> x(100, 5);
+    std::stringstream s;
+    x.write_to(s);
+    const std::string b = s.str().substr(0, sizeof(deque_stream_header) + 41 * sizeof(int) + 2);
+    ASSERT_EQ(b.size(), ::write(fd[1], b.data(), b.size()));
+    ::close(fd[1]);
+    my_deque<int> y;
+    ASSERT_THROW(y.read_from(fd[0]), std::runtime_error);
+    ASSERT_EQ(41, y.size());
+    ::close(fd[0]);
+}
+
+// -------------
+// TestSpscDeque
+// -------------
+
+TEST(TestSpscDeque, spsc_1){
+    spsc_deque<std::string, std::allocator<std::string>, block_elements<4> > x;
+    std::string v;
+    ASSERT_TRUE(x.empty());
+    ASSERT_FALSE(x.pop_front(v));
+    for(int i = 0; i < 10; ++i)
+        x.push_back(std::string(20, 'a' + i));
+    ASSERT_EQ(10, x.size());
+    for(int i = 0; i < 6; ++i) {
+        ASSERT_TRUE(x.pop_front(v));
+        ASSERT_EQ(std::string(20, 'a' + i), v);}
+    ASSERT_EQ(4, x.size());
+}
+
+TEST(TestSpscDeque, spsc_2){
+    typedef spsc_deque<int, counting_allocator<int>, block_elements<16> > queue_type;
+    queue_type x;
+    int v = 0;
+    for(int i = 0; i < 64; ++i)
+        x.push_back(i);
+    for(int i = 0; i < 64; ++i)
+        x.pop_front(v);
+    const int before = allocations;
+    for(int r = 0; r < 100; ++r) {
+        for(int i = 0; i < 48; ++i)
+            x.push_back(i);
+        for(int i = 0; i < 48; ++i) {
+            ASSERT_TRUE(x.pop_front(v));
+            ASSERT_EQ(i, v);}}
+    ASSERT_EQ(before, allocations);
+}
+
+TEST(TestSpscDeque, spsc_stress){
+    typedef spsc_deque<long, std::allocator<long>, block_elements<32> > queue_type;
+    const long n = 300000;
+    queue_type x;
+    long sum = 0;
+    bool ordered = true;
+    std::thread consumer([&] () {
+        long expected = 0;
+        long v;
+        while (expected != n)
+            if (x.pop_front(v)) {
+                ordered = ordered && (v == expected);
+                sum += v;
+                ++expected;}});
+    std::thread producer([&] () {
+        for(long i = 0; i < n; ++i)
+            x.push_back(i);});
+    producer.join();
+    consumer.join();
+    ASSERT_TRUE(ordered);
+    ASSERT_EQ(n * (n - 1) / 2, sum);
+    ASSERT_TRUE(x.empty());
+}
+
+// ---------------------
+// TestWorkStealingDeque
+// ---------------------
+
+TEST(TestWorkStealingDeque, owner_1){
+    work_stealing_deque<int> x(4);
+    int v = 0;
+    ASSERT_FALSE(x.pop_back(v));
+    ASSERT_FALSE(x.steal(v));
+    for(int i = 0; i < 100; ++i)
+        x.push_back(i);
+    ASSERT_EQ(100, x.size());
+    ASSERT_EQ(128, x.capacity());
+    ASSERT_TRUE(x.pop_back(v));
+    ASSERT_EQ(99, v);
+    ASSERT_TRUE(x.steal(v));
+    ASSERT_EQ(0, v);
+    ASSERT_TRUE(x.steal(v));
+    ASSERT_EQ(1, v);
+    ASSERT_EQ(97, x.size());
+}
+
+TEST(TestWorkStealingDeque, owner_2){
+    work_stealing_deque<long> x;
+    long v = 0;
+    for(int r = 0; r < 10; ++r) {
+        for(long i = 0; i < 50; ++i)
+            x.push_back(i);
+        for(long i = 49; i >= 0; --i) {
+            ASSERT_TRUE(x.pop_back(v));
+            ASSERT_EQ(i, v);}
+        ASSERT_TRUE(x.empty());}
+    ASSERT_EQ(64, x.capacity());
+}
+
+TEST(TestWorkStealingDeque, steal_stress){
+    const long n = 200000;
+    work_stealing_deque<long> x(16);
+    std::atomic<long> taken(0);
+    std::atomic<long> sum(0);
+    std::atomic<bool> done(false);
+    std::vector<std::thread> thieves;
+    for(int k = 0; k < 3; ++k)
+        thieves.push_back(std::thread([&] () {
+            long v;
+            while (!done.load() || !x.empty())
+                if (x.steal(v)) {
+                    sum += v;
+                    ++taken;}}));
+    long v;
+    for(long i = 0; i < n; ++i) {
+        x.push_back(i);
+        if ((i % 3 == 0) && x.pop_back(v)) {
+            sum += v;
+            ++taken;}}
+    while (x.pop_back(v)) {
+        sum += v;
+        ++taken;}
+    done = true;
+    for(std::size_t k = 0; k < thieves.size(); ++k)
+        thieves[k].join();
+    ASSERT_EQ(n, taken.load());
+    ASSERT_EQ(n * (n - 1) / 2, sum.load());
+}
+
+// ---------------
+// TestStaticDeque
+// ---------------
+
+TEST(TestStaticDeque, static_1){
+    static_deque<int, 8> x;
+    ASSERT_TRUE(x.empty());
+    for(int i = 0; i < 4; ++i) {
+        ASSERT_TRUE(x.push_back(i));
+        ASSERT_TRUE(x.push_front(-i - 1));}
+    ASSERT_TRUE(x.full());
+    ASSERT_EQ(-4, x.front());
+    ASSERT_EQ(3, x.back());
+    ASSERT_EQ(-1, x[3]);
+    ASSERT_EQ(0, x.at(4));
+    ASSERT_THROW(x.at(8), std::out_of_range);
+    ASSERT_TRUE(std::equal(x.begin(), x.end(), std::vector<int>({-4, -3, -2, -1, 0, 1, 2, 3}).begin()));
+    x.pop_front();
+    x.pop_back();
+    ASSERT_EQ(6, x.end() - x.begin());
+    static_deque<int, 8>::const_iterator b = x.begin();
+    ASSERT_EQ(-3, *b);
+    ASSERT_EQ(2, b[5]);
+}
+
+TEST(TestStaticDeque, static_2){
+    static_deque<std::string, 3, overflow_report> x;
+    ASSERT_TRUE(x.push_back("b"));
+    ASSERT_TRUE(x.push_front("a"));
+    ASSERT_TRUE(x.push_back("c"));
+    ASSERT_FALSE(x.push_back("d"));
+    ASSERT_FALSE(x.push_front("z"));
+    static_deque<std::string, 3, overflow_report> y(x);
+    x.pop_front();
+    ASSERT_TRUE(x.push_back("d"));
+    ASSERT_EQ("b", x.front());
+    ASSERT_EQ("d", x.back());
+    ASSERT_EQ("a", y.front());
+    y = x;
+    ASSERT_TRUE(x == y);
+    static_deque<int, 2, overflow_throw> z(2, 7);
+    ASSERT_THROW(z.push_front(1), std::length_error);
+    ASSERT_EQ(2, z.size());
+}
+
+#if __cplusplus >= 201402L
+constexpr static_deque<int, 4> make_static_deque () {
+    static_deque<int, 4> d;
+    d.push_back(2);
+    d.push_front(1);
+    d.push_back(3);
+    d.pop_front();
+    return d;}
+#endif
+
+TEST(TestStaticDeque, static_3){
+    constexpr static_deque<int, 16> x;
+    static_assert(x.empty(), "");
+    static_assert(x.capacity() == 16, "");
+    static_assert(x.begin() == x.end(), "");
+    static_assert(std::is_trivially_destructible<static_deque<int, 16> >::value, "");
+#if __cplusplus >= 201402L
+    constexpr static_deque<int, 4> y = make_static_deque();
+    static_assert(y.size() == 2 && y.front() == 2 && y[1] == 3, "");
+#endif
+    static_deque<double, 4> z({1.5, 2.5});
+    ASSERT_EQ(2, z.size());
+    ASSERT_EQ(2.5, z.back());
+}
+
+int live_copies = 0;
+
+struct fragile {
+    int v;
+
+    explicit fragile (int x) : v(x) {
+        ++live_copies;}
+
+    fragile (const fragile& that) : v(that.v) {
+        if (v < 0)
+            throw std::runtime_error("fragile copy");
+        ++live_copies;}
+
+    fragile (fragile&& that) noexcept : v(that.v) {
+        that.v = 0;
+        ++live_copies;}
+
+    fragile& operator = (const fragile&) = default;
+
+    ~fragile () {
+        --live_copies;}};
+
+TEST(TestStaticDeque, static_4){
+    live_copies = 0;
+    {
+        typedef static_deque<fragile, 4> deque_type;
+        deque_type x;
+        x.emplace_back(1);
+        x.emplace_back(2);
+        x.emplace_back(-3);
+        ASSERT_EQ(3, live_copies);
+        ASSERT_THROW(deque_type y(x), std::runtime_error);
+        ASSERT_EQ(3, live_copies);
+    }
+    ASSERT_EQ(0, live_copies);
+}
+
+TEST(TestStaticDeque, static_5){
+    typedef static_deque<std::string, 4> deque_type;
+    static_assert(std::is_nothrow_move_constructible<deque_type>::value, "");
+    deque_type x;
+    x.push_back("b");
+    x.push_front("a");
+    x.push_back(std::string(100, 'c'));
+    deque_type y(std::move(x));
+    ASSERT_EQ(3, y.size());
+    ASSERT_EQ("a", y.front());
+    ASSERT_EQ(std::string(100, 'c'), y.back());
+    ASSERT_EQ(3, x.size());
+    ASSERT_TRUE(x.back().empty());
+    deque_type z({"z"});
+    z = std::move(y);
+    ASSERT_EQ(3, z.size());
+    ASSERT_EQ("b", z[1]);
+    ASSERT_EQ(std::string(100, 'c'), z.back());
+    live_copies = 0;
+    {
+        static_deque<fragile, 2> f;
+        f.emplace_back(-1);
+        static_deque<fragile, 2> g(std::move(f));
+        ASSERT_EQ(-1, g.front().v);
+        ASSERT_EQ(2, live_copies);
+    }
+    ASSERT_EQ(0, live_copies);
+}
+
+// -------------
+// TestRingDeque
+// -------------
+
+TEST(TestRingDeque, ring_1){
+    ring_deque<int, counting_allocator<int> > x(5);
+    const int before = allocations;
+    for(int i = 0; i < 12; ++i)
+        x.push_back(i);
+    ASSERT_EQ(before, allocations);
+    ASSERT_EQ(5, x.size());
+    ASSERT_EQ(7, x.overwritten());
+    ASSERT_EQ(7, x.front());
+    ASSERT_EQ(11, x.back());
+    ASSERT_TRUE(std::equal(x.begin(), x.end(), std::vector<int>({7, 8, 9, 10, 11}).begin()));
+    x.pop_front();
+    x.push_back(12);
+    ASSERT_EQ(7, x.overwritten());
+    ASSERT_EQ(8, x[0]);
+}
+
+TEST(TestRingDeque, ring_2){
+    ring_deque<std::string> x(3);
+    x.push_back("a");
+    x.push_back("b");
+    x.push_back("c");
+    x.push_front("z");
+    ASSERT_EQ(1, x.overwritten());
+    ASSERT_EQ("z", x.front());
+    ASSERT_EQ("b", x.back());
+    ring_deque<std::string> y(x);
+    x.push_back("d");
+    ASSERT_EQ("a", x.front());
+    ASSERT_EQ("z", y.front());
+    y = x;
+    ASSERT_EQ("d", y.back());
+    ASSERT_EQ(2, y.overwritten());
+    ring_deque<std::string> z(0);
+    z.push_back("q");
+    ASSERT_TRUE(z.empty());
+}
+
+TEST(TestRingDeque, ring_3){
+    ring_deque<int> x(8);
+    for(int i = 0; i < 6; ++i)
+        x.push_back(i);
+    ring_deque<int>::const_span_pair s = static_cast<const ring_deque<int>&>(x).spans();
+    ASSERT_EQ(6, s.first.size());
+    ASSERT_EQ(0, s.second.size());
+    for(int i = 6; i < 11; ++i)
+        x.push_back(i);
+    ring_deque<int>::span_pair t = x.spans();
+    ASSERT_EQ(5, t.first.size());
+    ASSERT_EQ(3, t.second.size());
+    ASSERT_EQ(3, *t.first.begin());
+    ASSERT_EQ(8, *t.second.begin());
+    std::vector<int> v(t.first.begin(), t.first.end());
+    v.insert(v.end(), t.second.begin(), t.second.end());
+    ASSERT_TRUE(std::equal(v.begin(), v.end(), x.begin()));
+}
+
+TEST(TestRingDeque, ring_4){
+    ring_deque<std::string> x(3);
+    x.emplace_back(2, 'b');
+    x.emplace_front(1, 'a');
+    x.emplace_back(3, 'c');
+    ASSERT_TRUE(x.full());
+    x.emplace_back(4, 'd');
+    ASSERT_EQ("bb", x.front());
+    ASSERT_EQ("dddd", x.back());
+    x.emplace_front(5, 'e');
+    ASSERT_EQ("eeeee", x.front());
+    ASSERT_EQ("ccc", x.back());
+    ASSERT_EQ(2, x.overwritten());
+    ring_deque<std::string>::iterator b = x.begin();
+    ring_deque<std::string>::iterator e = x.end();
+    ASSERT_TRUE(e > b);
+    ASSERT_TRUE(b <= b);
+    ASSERT_TRUE(e >= b);
+    ASSERT_FALSE(b > e);
+    ASSERT_TRUE(2 + b == b + 2);
+    ASSERT_EQ("ccc", *(2 + b));
+    std::sort(x.begin(), x.end());
+    ASSERT_EQ("bb", x.front());
+    ASSERT_EQ("eeeee", x.back());
+}
+
+// ---------------
+// TestMappedDeque
+// ---------------
+
+/**
+ * a file name no other test run is using, removed up front
+ */
+std::string mapped_path (const char* name) {
+    std::ostringstream s;
+    s << "/tmp/TestDeque." << ::getpid() << "." << name;
+    std::remove(s.str().c_str());
+    return s.str();}
+
+TEST(TestMappedDeque, mapped_1){
+    const std::string p = mapped_path("mapped_1");
+    {
+    mapped_deque<int> x(p.c_str(), 4096, 64);
+    ASSERT_TRUE(x.empty());
+    for(int i = 0; i < 5000; ++i)
+        x.push_back(i);
+    for(int i = 1; i <= 3000; ++i)
+        x.push_front(-i);
+    ASSERT_EQ(8000, x.size());
+    ASSERT_EQ(-3000, x.front());
+    ASSERT_EQ(4999, x.back());
+    ASSERT_EQ(0, x[3000]);
+    ASSERT_EQ(1234, x.at(4234));
+    ASSERT_THROW(x.at(8000), std::out_of_range);
+    for(int i = 0; i < 2000; ++i)
+        x.pop_front();
+    for(int i = 0; i < 1000; ++i)
+        x.pop_back();
+    ASSERT_EQ(-1000, x.front());
+    ASSERT_EQ(3999, x.back());
+    x.sync();
+    }
+    std::remove(p.c_str());
+}
+
+TEST(TestMappedDeque, mapped_2){
+    const std::string p = mapped_path("mapped_2");
+    {
+    mapped_deque<double> x(p.c_str(), 4096, 64);
+    for(int i = 0; i < 3000; ++i)
+        x.push_back(i / 2.0);
+    for(int i = 0; i < 1000; ++i)
+        x.pop_front();
+    }
+    {
+    mapped_deque<double> x(p.c_str());
+    ASSERT_EQ(2000, x.size());
+    ASSERT_EQ(500.0, x.front());
+    ASSERT_EQ(1499.5, x.back());
+    ASSERT_EQ(4096, x.block_bytes());
+    x.push_back(-1.0);
+    }
+    {
+    mapped_deque<double> x(p.c_str());
+    ASSERT_EQ(2001, x.size());
+    ASSERT_EQ(-1.0, x.back());
+    }
+    ASSERT_THROW(mapped_deque<int> y(p.c_str()), std::runtime_error);
+    std::remove(p.c_str());
+}
+
+TEST(TestMappedDeque, mapped_3){
+    const std::string p = mapped_path("mapped_3");
+    {
+    mapped_deque<int> x(p.c_str(), 4096, 4);
+    for(int i = 0; i < 100000; ++i) {
+        x.push_back(i);
+        if (x.size() > 1500) {
+            ASSERT_EQ(i - 1500, x.front());
+            x.pop_front();}}
+    ASSERT_GE(4, x.file_blocks());
+    x.clear();
+    ASSERT_TRUE(x.empty());
+    for(int i = 0; i < 4096; ++i)
+        x.push_back(i);
+    ASSERT_THROW(x.push_back(0), std::length_error);
+    ASSERT_THROW(x.push_front(0), std::length_error);
+    ASSERT_EQ(4096, x.size());
+    for(int i = 0; i < 1024; ++i)
+        x.pop_front();
+    x.push_back(7);
+    ASSERT_EQ(7, x.back());
+    ASSERT_EQ(1024, x.front());
+    }
+    std::remove(p.c_str());
+}
@@ -0,0 +1,176 @@
+// -----------------------------------
+// projects/deque/TestDequeChecked.c++
+// -----------------------------------
+
+/*
+The tests of the opt-in modes, DEQUE_STATS and DEQUE_DEBUG, which change
+my_deque's layout, so they get their own program; TestDeque.c++ tests the
+default build.
+
+To compile the test:
+    % g++-4.7 -pedantic -std=c++11 -Wall TestDequeChecked.c++ -o TestDequeChecked -lgtest -lgtest_main -lpthread
+*/
+
+// --------
+// includes
+// --------
+
+#include <stdexcept> // out_of_range
+
+#include "gtest/gtest.h"
+
+#define DEQUE_STATS 2               // test the counters, global ones included
+#define DEQUE_DEBUG 1               // and the checks
+#include "Deque.h"
+
+// ---------
+// TestStats
+// ---------
+
+TEST(TestStats, stats_1){
+    my_deque<int> x;
+    for(int i = 0; i < 1000; ++i)
+        x.push_back(i);
+    for(int i = 0; i < 10; ++i)
+        x.push_front(i);
+    deque_stats s = x.stats();
+    ASSERT_EQ(1010, s.constructions);
+    ASSERT_EQ(1000, s.back_ops);
+    ASSERT_EQ(10, s.front_ops);
+    ASSERT_EQ(1010, s.max_size);
+    ASSERT_EQ(0, s.copies);
+    ASSERT_LT(0, s.growths);
+    ASSERT_EQ(s.growths, s.deallocations);
+    ASSERT_LE(1010 * sizeof(int), s.bytes_reserved);
+    for(int i = 0; i < 500; ++i)
+        x.pop_front();
+    s = x.stats();
+    ASSERT_EQ(510, s.front_ops);
+    ASSERT_EQ(1010, s.max_size);
+    ASSERT_GT(s.allocations, s.deallocations);
+}
+
+TEST(TestStats, stats_2){
+    my_deque<int> x(100, 1);
+    ASSERT_EQ(100, x.stats().copies);
+    my_deque<int> y(x);
+    ASSERT_EQ(100, y.stats().copies);
+    ASSERT_EQ(0, y.stats().constructions);
+    x.reset_stats();
+    ASSERT_EQ(0, x.stats().copies);
+    x.insert(x.begin() + 10, 7);
+    ASSERT_EQ(10, x.stats().moves);
+    x.erase(x.begin() + 90);
+    ASSERT_EQ(20, x.stats().moves);
+    my_deque<int> z(std::move(y));
+    ASSERT_EQ(0, z.stats().moves);
+    ASSERT_EQ(0, z.stats().allocations);
+}
+
+TEST(TestStats, stats_3){
+    reset_global_deque_stats();
+    {
+    my_deque<double> x;
+    for(int i = 0; i < 300; ++i)
+        x.push_back(i);
+    x.reset_stats();
+    x.push_front(0);
+    my_deque<double> y(10, 0.5);
+    }
+    const deque_stats s = global_deque_stats();
+    ASSERT_EQ(301, s.back_ops + s.front_ops);
+    ASSERT_EQ(10, s.copies);
+    ASSERT_EQ(301, s.max_size);
+    ASSERT_EQ(s.allocations, s.deallocations);
+    ASSERT_EQ(0, s.bytes_reserved);
+}
+
+TEST(TestStats, stats_4){
+    static_assert(sizeof(my_deque<int>) <= 8 * sizeof(void*) + sizeof(deque_stats) + sizeof(void*), "");
+    my_deque<int> x;
+    for(int i = 0; i < 1000; ++i)
+        x.push_back(i);
+    x.erase(x.begin(), x.begin() + 300);
+    x.reserve_back(1000);
+    ASSERT_EQ(x.stats().bytes_reserved, x.memory_usage().total_bytes());
+    x.shrink_to_fit();
+    ASSERT_EQ(x.stats().bytes_reserved, x.memory_usage().total_bytes());
+}
+
+// ---------
+// TestDebug
+// ---------
+
+TEST(TestDebug, debug_1){
+    my_deque<int> x(300, 4);
+    ASSERT_EQ(4, x.at(299));
+    ASSERT_THROW(x.at(300), std::out_of_range);
+    const my_deque<int> y;
+    ASSERT_THROW(y.at(0), std::out_of_range);
+    ASSERT_DEATH(x[300], "operator\\[\\] index out of range");
+}
+
+TEST(TestDebug, debug_2){
+    my_deque<int> x(10, 1);
+    my_deque<int>::iterator b = x.begin();
+    my_deque<int>::const_iterator c = x.begin();
+    x.push_back(2);
+    x.pop_front();
+    ASSERT_EQ(1, *b);
+    ASSERT_EQ(1, *c);
+    for(int i = 0; i < 10000; ++i)
+        x.push_front(i);
+    ASSERT_DEATH(*b, "iterator used after the deque reallocated");
+    ASSERT_DEATH(++c, "iterator used after the deque reallocated");
+    b = x.begin();
+    ASSERT_EQ(9999, *b);
+}
+
+TEST(TestDebug, debug_3){
+    my_deque<int> x(10, 1);
+    my_deque<int>::iterator b = x.begin();
+    x.shrink_to_fit();
+    ASSERT_DEATH(b + 1, "reallocated");
+    my_deque<int>::iterator e = x.end();
+    x.clear();
+    ASSERT_DEATH(e - x.begin(), "reallocated");
+}
+
+TEST(TestDebug, debug_4){
+    my_deque<int> x;
+    x.max_spare_blocks(0);
+    for(int i = 0; i < 1000; ++i)
+        x.push_back(i);
+    my_deque<int>::iterator b = x.begin();
+    my_deque<int>::iterator m = x.begin() + 500;
+    for(int i = 0; i < 200; ++i)
+        x.pop_front();
+    ASSERT_EQ(500, *m);
+    ASSERT_EQ(300, m - x.begin());
+    ASSERT_DEATH(*b, "its block was freed");
+    b = x.begin();
+    ASSERT_EQ(200, *b);
+}
+
+TEST(TestDebug, debug_5){
+    my_deque<int> x;
+    x.max_spare_blocks(0);
+    for(int i = 0; i < 1000; ++i)
+        x.push_back(i);
+    my_deque<int>::const_iterator e = x.end() - 1;
+    my_deque<int>::const_iterator m = x.begin() + 500;
+    for(int i = 0; i < 200; ++i)
+        x.pop_back();
+    ASSERT_DEATH(*e, "its block was freed");
+    ASSERT_DEATH(x.end() - e, "its block was freed");
+    ASSERT_EQ(500, *m);
+    ASSERT_EQ(299, x.end() - ++m);
+}
+
+TEST(TestDebug, debug_6){
+    my_deque<int>::iterator b;
+    my_deque<int>::const_iterator c;
+    ASSERT_TRUE(b == my_deque<int>::iterator());
+    ASSERT_DEATH(*b, "singular iterator used");
+    ASSERT_DEATH(++c, "singular iterator used");
+}
@@ -0,0 +1,112 @@
+// ------------------------------------
+// projects/deque/WorkStealingBench.c++
+// ------------------------------------
+
+// --------
+// includes
+// --------
+
+#include <atomic>    // atomic
+#include <chrono>    // steady_clock
+#include <cstdio>    // printf
+#include <cstdlib>   // atoi
+#include <random>    // minstd_rand
+#include <thread>    // thread, hardware_concurrency
+#include <vector>    // vector
+
+#include "WorkStealingDeque.h"
+
+// ----
+// task
+// ----
+
+/**
+ * a task is a depth: depth 0 is a leaf that does a little arithmetic, any
+ * other depth spawns two tasks one level down, so one root at depth d makes
+ * 2^(d+1) - 1 tasks
+ */
+typedef unsigned task;
+
+// ----
+// pool
+// ----
+
+/**
+ * fixed set of workers, each owning one work_stealing_deque, that pop their
+ * own work from the back and steal from a random victim's front when empty
+ */
+class pool {
+    private:
+        std::vector<work_stealing_deque<task>*> _deques;
+        std::atomic<long>                       _pending;   // tasks pushed but not finished
+        std::atomic<unsigned long>              _checksum;
+
+        void run (unsigned w) {
+            work_stealing_deque<task>& mine = *_deques[w];
+            std::minstd_rand r(w + 1);
+            unsigned long local = 0;
+            task t;
+            while (_pending.load(std::memory_order_acquire) != 0) {
+                if (!mine.pop_back(t)) {
+                    const unsigned v = r() % _deques.size();
+                    if ((v == w) || !_deques[v]->steal(t))
+                        continue;}
+                if (t == 0) {
+                    unsigned x = 2166136261u;
+                    for (unsigned i = 0; i != 64; ++i)
+                        x = (x ^ i) * 16777619u;
+                    local += x & 1;}
+                else {
+                    _pending.fetch_add(2, std::memory_order_relaxed);
+                    mine.push_back(t - 1);
+                    mine.push_back(t - 1);}
+                _pending.fetch_sub(1, std::memory_order_release);}
+            _checksum += local;}
+
+    public:
+        explicit pool (unsigned workers) :
+                _deques(workers), _pending(0), _checksum(0) {
+            for (unsigned w = 0; w != workers; ++w)
+                _deques[w] = new work_stealing_deque<task>();}
+
+        ~pool () {
+            for (unsigned w = 0; w != _deques.size(); ++w)
+                delete _deques[w];}
+
+        /**
+         * @param depth - depth of the root task
+         * @return seconds until every task has run
+         */
+        double execute (task depth) {
+            _pending = 1;
+            _deques[0]->push_back(depth);
+            const std::chrono::steady_clock::time_point b = std::chrono::steady_clock::now();
+            std::vector<std::thread> threads;
+            for (unsigned w = 0; w != _deques.size(); ++w)
+                threads.push_back(std::thread(&pool::run, this, w));
+            for (unsigned w = 0; w != threads.size(); ++w)
+                threads[w].join();
+            return std::chrono::duration<double>(std::chrono::steady_clock::now() - b).count();}};
+
+// ----
+// main
+// ----
+
+/**
+ * usage: WorkStealingBench [depth [max_threads]]
+ * prints one line per thread count, doubling up to max_threads
+ */
+int main (int argc, char* argv[]) {
+    const task     depth   = (argc > 1) ? std::atoi(argv[1]) : 22;
+    const unsigned cores   = std::thread::hardware_concurrency() ? std::thread::hardware_concurrency() : 1;
+    const unsigned maximum = (argc > 2) ? std::atoi(argv[2]) : cores;
+    const double   tasks   = double(2UL << depth) - 1;
+    std::printf("%8s %10s %14s %8s\n", "threads", "seconds", "tasks/s", "speedup");
+    double base = 0;
+    for (unsigned n = 1; n <= maximum; n = (n * 2 > maximum && n != maximum) ? maximum : n * 2) {
+        pool p(n);
+        const double s = p.execute(depth);
+        if (n == 1)
+            base = s;
+        std::printf("%8u %10.3f %14.0f %8.2f\n", n, s, tasks / s, base / s);}
+    return 0;}
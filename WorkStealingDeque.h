@@ -0,0 +1,264 @@
+// ----------------------------------
+// projects/deque/WorkStealingDeque.h
+// ----------------------------------
+
+#ifndef WorkStealingDeque_h
+#define WorkStealingDeque_h
+
+// --------
+// includes
+// --------
+
+#include <atomic>      // atomic, atomic_thread_fence, memory_order_*
+#include <cassert>     // assert
+#include <cstddef>     // ptrdiff_t, size_t
+#include <memory>      // allocator, allocator_traits
+#include <new>         // placement new
+#include <type_traits> // is_trivially_copyable
+
+// -------------------
+// work_stealing_deque
+// -------------------
+
+/**
+ * Chase-Lev deque for a work stealing scheduler, with the memory orders of
+ * Le, Pop, Cohen and Zappa Nardelli, "Correct and Efficient Work-Stealing
+ * for Weak Memory Models", 2013
+ * one owner thread pushes and pops at the back without locks, any number of
+ * thieves take from the front with a compare and swap on the front index
+ * the elements live in a circular array that doubles when it is full; the
+ * arrays it outgrows are kept until destruction, because a thief may still
+ * be reading one
+ * T must be trivially copyable, since a thief reads its element before it
+ * knows whether it won the race for it
+ */
+template < typename T, typename A = std::allocator<T> >
+class work_stealing_deque {
+    static_assert(std::is_trivially_copyable<T>::value, "work_stealing_deque needs a trivially copyable T");
+
+    public:
+        // --------
+        // typedefs
+        // --------
+
+        typedef A           allocator_type;
+        typedef T           value_type;
+        typedef std::size_t size_type;
+
+        static const size_type DEFAULT_CAPACITY = 64;
+
+    private:
+        typedef std::ptrdiff_t index_type;
+
+        // ----
+        // ring
+        // ----
+
+        struct ring {
+            index_type          mask;      // capacity - 1, capacity is a power of two
+            std::atomic<T>*     slots;
+            ring*               previous;  // the ring this one replaced
+
+            T get (index_type i) const {
+                return slots[i & mask].load(std::memory_order_relaxed);}
+
+            void put (index_type i, const T& v) {
+                slots[i & mask].store(v, std::memory_order_relaxed);}};
+
+        typedef typename std::allocator_traits<allocator_type>::template rebind_alloc<ring>           ring_allocator;
+        typedef typename std::allocator_traits<allocator_type>::template rebind_alloc<std::atomic<T> > slot_allocator;
+        typedef std::allocator_traits<ring_allocator> ring_traits;
+        typedef std::allocator_traits<slot_allocator> slot_traits;
+
+        static const size_type CACHE_LINE = 64;
+
+        // ----
+        // data
+        // ----
+
+        ring_allocator           _ra;
+        slot_allocator           _sa;
+
+        char                     _pad_0[CACHE_LINE];
+        std::atomic<index_type>  _top;      // front, advanced by thieves and by the owner's last pop
+        char                     _pad_1[CACHE_LINE];
+        std::atomic<index_type>  _bottom;   // back, owner only writes it
+        std::atomic<ring*>       _ring;
+
+        work_stealing_deque (const work_stealing_deque&);
+        work_stealing_deque& operator = (const work_stealing_deque&);
+
+        // -------------
+        // allocate_ring
+        // -------------
+
+        /**
+         * @param capacity - power of two
+         * @return an empty ring of that capacity
+         */
+        ring* allocate_ring (size_type capacity) {
+            ring* r = ring_traits::allocate(_ra, 1);
+            r->mask     = capacity - 1;
+            r->slots    = slot_traits::allocate(_sa, capacity);
+            r->previous = 0;
+            for (size_type i = 0; i != capacity; ++i)
+                ::new (static_cast<void*>(r->slots + i)) std::atomic<T>();
+            return r;}
+
+        // ----
+        // grow
+        // ----
+
+        /**
+         * @param r - full ring
+         * @param t - front index
+         * @param b - back index
+         * @return a ring twice the size holding [t, b), now the current one
+         * owner side only
+         */
+        ring* grow (ring* r, index_type t, index_type b) {
+            ring* n = allocate_ring(2 * (r->mask + 1));
+            for (index_type i = t; i != b; ++i)
+                n->put(i, r->get(i));
+            n->previous = r;
+            _ring.store(n, std::memory_order_release);
+            return n;}
+
+    public:
+        // ------------
+        // constructors
+        // ------------
+
+        /**
+         * @param capacity - initial capacity, rounded up to a power of two
+         * @param a - allocator - defaulted
+         */
+        explicit work_stealing_deque (size_type capacity = DEFAULT_CAPACITY, const allocator_type& a = allocator_type()) :
+                _ra(a), _sa(a), _top(0), _bottom(0), _ring(0) {
+            size_type c = 1;
+            while (c < capacity)
+                c *= 2;
+            _ring.store(allocate_ring(c), std::memory_order_relaxed);}
+
+        // ----------
+        // destructor
+        // ----------
+
+        /**
+         * frees the current ring and every ring it replaced
+         * no thread may still be using the deque
+         */
+        ~work_stealing_deque () {
+            ring* r = _ring.load(std::memory_order_relaxed);
+            while (r) {
+                ring* p = r->previous;
+                slot_traits::deallocate(_sa, r->slots, r->mask + 1);
+                ring_traits::deallocate(_ra, r, 1);
+                r = p;}}
+
+        // --------
+        // capacity
+        // --------
+
+        /**
+         * @return number of elements the current ring holds before it grows
+         */
+        size_type capacity () const {
+            return _ring.load(std::memory_order_acquire)->mask + 1;}
+
+        // -----
+        // empty
+        // -----
+
+        /**
+         * @return whether the deque held nothing at the moment of the call
+         */
+        bool empty () const {
+            return size() == 0;}
+
+        // --------
+        // pop_back
+        // --------
+
+        /**
+         * @param v - where the last element is copied to
+         * @return false when the deque is empty or a thief took the last element
+         * owner side only
+         */
+        bool pop_back (value_type& v) {
+            const index_type b = _bottom.load(std::memory_order_relaxed) - 1;
+            ring* r = _ring.load(std::memory_order_relaxed);
+            _bottom.store(b, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            index_type t = _top.load(std::memory_order_relaxed);
+            if (t > b) {
+                _bottom.store(b + 1, std::memory_order_relaxed);
+                return false;}
+            v = r->get(b);
+            if (t == b) {
+                const bool won = _top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+                _bottom.store(b + 1, std::memory_order_relaxed);
+                return won;}
+            return true;}
+
+        // ---------
+        // push_back
+        // ---------
+
+        /**
+         * @param v - value to append
+         * owner side only
+         */
+        void push_back (const value_type& v) {
+            const index_type b = _bottom.load(std::memory_order_relaxed);
+            const index_type t = _top.load(std::memory_order_acquire);
+            ring* r = _ring.load(std::memory_order_relaxed);
+            if (b - t > r->mask)
+                r = grow(r, t, b);
+            r->put(b, v);
+            std::atomic_thread_fence(std::memory_order_release);
+            _bottom.store(b + 1, std::memory_order_relaxed);}
+
+        // ----
+        // size
+        // ----
+
+        /**
+         * @return number of elements at the moment of the call, a snapshot
+         * while other threads are running
+         */
+        size_type size () const {
+            const index_type b = _bottom.load(std::memory_order_acquire);
+            const index_type t = _top.load(std::memory_order_acquire);
+            return (b > t) ? (b - t) : 0;}
+
+        // -----
+        // steal
+        // -----
+
+        /**
+         * @param v - where the first element is copied to
+         * @return false when the deque is empty or another thread won the
+         * race for the first element
+         * any thread
+         */
+        bool steal (value_type& v) {
+            index_type t = _top.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            const index_type b = _bottom.load(std::memory_order_acquire);
+            if (t >= b)
+                return false;
+            ring* r = _ring.load(std::memory_order_acquire);
+            const T x = r->get(t);
+            if (!_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                return false;
+            v = x;
+            return true;}};
+
+template <typename T, typename A>
+const typename work_stealing_deque<T, A>::size_type work_stealing_deque<T, A>::DEFAULT_CAPACITY;
+
+template <typename T, typename A>
+const typename work_stealing_deque<T, A>::size_type work_stealing_deque<T, A>::CACHE_LINE;
+
+#endif // WorkStealingDeque_h